@@ -26,6 +26,8 @@ TreelandConfig::TreelandConfig()
     , m_fontSize(m_dconfig->value("fontSize", 105).toUInt())
     , m_iconThemeName(m_dconfig->value("iconThemeName").toString())
     , m_defaultBackground(m_dconfig->value("defaultBackground").toString())
+    , m_captureFrameRingSize(m_dconfig->value("captureFrameRingSize", 2).toUInt())
+    , m_keyBindings(m_dconfig->value("keyBindings").toMap())
 {
     connect(m_dconfig.get(), &DConfig::valueChanged, this, &TreelandConfig::onDConfigChanged);
 }
@@ -564,3 +566,17 @@ QString TreelandConfig::defaultBackground()
 
     return m_defaultBackground;
 }
+
+uint TreelandConfig::captureFrameRingSize()
+{
+    m_captureFrameRingSize = m_dconfig->value("captureFrameRingSize", 2).toUInt();
+
+    return m_captureFrameRingSize;
+}
+
+QVariantMap TreelandConfig::keyBindings()
+{
+    m_keyBindings = m_dconfig->value("keyBindings").toMap();
+
+    return m_keyBindings;
+}
@@ -9,6 +9,7 @@
 #include <QObject>
 #include <QQmlEngine>
 #include <QSize>
+#include <QVariantMap>
 
 class TreelandConfig
     : public QObject
@@ -51,6 +52,7 @@ class TreelandConfig
     Q_PROPERTY(uint32_t fontSize READ fontSize WRITE setFontSize NOTIFY fontSizeChanged FINAL)
     Q_PROPERTY(QString iconThemeName READ iconThemeName WRITE setIconThemeName NOTIFY iconThemeNameChanged FINAL)
     Q_PROPERTY(QString defaultBackground READ defaultBackground NOTIFY defaultBackgroundChanged FINAL)
+    Q_PROPERTY(uint captureFrameRingSize READ captureFrameRingSize NOTIFY captureFrameRingSizeChanged FINAL)
 public:
     TreelandConfig();
 
@@ -154,6 +156,10 @@ public:
 
     QString defaultBackground();
 
+    uint captureFrameRingSize();
+
+    QVariantMap keyBindings();
+
 Q_SIGNALS:
     void workspaceThumbMarginChanged();
     void workspaceThumbHeightChanged();
@@ -189,6 +195,8 @@ Q_SIGNALS:
     void fontSizeChanged();
     void iconThemeNameChanged();
     void defaultBackgroundChanged();
+    void captureFrameRingSizeChanged();
+    void keyBindingsChanged();
 
 private:
     void onDConfigChanged(const QString &key);
@@ -211,6 +219,8 @@ private:
     qreal m_windowRadius;
     QString m_iconThemeName;
     QString m_defaultBackground;
+    uint m_captureFrameRingSize;
+    QVariantMap m_keyBindings;
 
     // Local
     uint m_workspaceThumbHeight = 144;
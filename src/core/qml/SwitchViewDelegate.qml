@@ -90,6 +90,8 @@ Item {
                 SurfaceProxy {
                     id: proxy
                     live: true
+                    // Current window is shown live by the large preview
+                    thumbnail: true
                     anchors.centerIn: parent
                     surface: windowItem.surface
                     maxSize: Qt.size(parent.width, parent.height)
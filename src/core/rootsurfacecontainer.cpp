@@ -12,11 +12,15 @@
 #include <woutputitem.h>
 #include <woutputlayout.h>
 #include <wxdgpopupsurface.h>
+#include <wxdgtoplevelsurface.h>
 
 #include <qwoutputlayout.h>
+#include <qwxdgshell.h>
 
 #include <QQuickWindow>
 
+#include <utility>
+
 WAYLIB_SERVER_USE_NAMESPACE
 
 OutputListModel::OutputListModel(QObject *parent)
@@ -77,22 +81,12 @@ void RootSurfaceContainer::init(WServer *server)
 
 SurfaceWrapper *RootSurfaceContainer::getSurface(WSurface *surface) const
 {
-    const auto surfaces = this->surfaces();
-    for (const auto &wrapper : surfaces) {
-        if (wrapper->surface() == surface)
-            return wrapper;
-    }
-    return nullptr;
+    return m_surfaceIndex.value(surface);
 }
 
 SurfaceWrapper *RootSurfaceContainer::getSurface(WToplevelSurface *surface) const
 {
-    const auto surfaces = this->surfaces();
-    for (const auto &wrapper : surfaces) {
-        if (wrapper->shellSurface() == surface)
-            return wrapper;
-    }
-    return nullptr;
+    return m_shellSurfaceIndex.value(surface);
 }
 
 void RootSurfaceContainer::destroyForSurface(SurfaceWrapper *wrapper)
@@ -153,14 +147,58 @@ void RootSurfaceContainer::beginMoveResize(SurfaceWrapper *surface, Qt::Edges ed
     moveResizeState.surface = surface;
     moveResizeState.startGeometry = surface->geometry();
     moveResizeState.resizeEdges = edges;
+    moveResizeState.pendingIncrement.reset();
     surface->setXwaylandPositionFromSurface(false);
     surface->setPositionAutomatic(false);
+
+    if (auto toplevel = qobject_cast<WXdgToplevelSurface *>(surface->shellSurface());
+        toplevel && edges) {
+        // Held back resizes are applied in the first frame after the client acked.
+        moveResizeState.ackConnection = connect(
+            qw_xdg_surface::from(toplevel->handle()->handle()->base),
+            &qw_xdg_surface::notify_ack_configure,
+            this,
+            [this] {
+                if (moveResizeState.pendingIncrement)
+                    polish();
+            });
+    }
 }
 
 void RootSurfaceContainer::doMoveResize(const QPointF &incrementPos)
 {
     Q_ASSERT(moveResizeState.surface);
 
+    // Motion can arrive far faster than the display refresh, only the latest position of
+    // each frame is applied, see updatePolish().
+    moveResizeState.pendingIncrement = incrementPos;
+    polish();
+}
+
+void RootSurfaceContainer::updatePolish()
+{
+    SurfaceContainer::updatePolish();
+
+    if (!moveResizeState.surface || !moveResizeState.pendingIncrement)
+        return;
+
+    // Don't pile up configures the client has not caught up with.
+    if (moveResizeState.resizeEdges && hasUnackedConfigure(moveResizeState.surface))
+        return;
+
+    applyMoveResize(*std::exchange(moveResizeState.pendingIncrement, std::nullopt));
+}
+
+bool RootSurfaceContainer::hasUnackedConfigure(SurfaceWrapper *surface) const
+{
+    auto toplevel = qobject_cast<WXdgToplevelSurface *>(surface->shellSurface());
+    if (!toplevel)
+        return false;
+    return !wl_list_empty(&toplevel->handle()->handle()->base->configure_list);
+}
+
+void RootSurfaceContainer::applyMoveResize(const QPointF &incrementPos)
+{
     if (moveResizeState.resizeEdges) {
         QRectF geo = moveResizeState.startGeometry;
 
@@ -188,11 +226,25 @@ void RootSurfaceContainer::cancelMoveResize(SurfaceWrapper *surface)
     endMoveResize();
 }
 
+void RootSurfaceContainer::finishMoveResize()
+{
+    if (!moveResizeState.surface)
+        return;
+
+    // The last motion always lands, even if the client is still behind.
+    if (moveResizeState.pendingIncrement)
+        applyMoveResize(*std::exchange(moveResizeState.pendingIncrement, std::nullopt));
+    endMoveResize();
+}
+
 void RootSurfaceContainer::endMoveResize()
 {
     if (!moveResizeState.surface)
         return;
 
+    moveResizeState.pendingIncrement.reset();
+    QObject::disconnect(moveResizeState.ackConnection);
+
     auto o = moveResizeState.surface->ownsOutput();
     moveResizeState.surface->shellSurface()->setResizeing(false);
 
@@ -245,6 +297,8 @@ void RootSurfaceContainer::removeSurface(SurfaceWrapper *)
 void RootSurfaceContainer::addBySubContainer(SurfaceContainer *sub, SurfaceWrapper *surface)
 {
     SurfaceContainer::addBySubContainer(sub, surface);
+    m_surfaceIndex.insert(surface->surface(), surface);
+    m_shellSurfaceIndex.insert(surface->shellSurface(), surface);
     connect(surface, &SurfaceWrapper::geometryChanged, this, [this, surface] {
         updateSurfaceOutputs(surface);
     });
@@ -292,6 +346,12 @@ void RootSurfaceContainer::removeBySubContainer(SurfaceContainer *sub, SurfaceWr
         endMoveResize();
 
     SurfaceContainer::removeBySubContainer(sub, surface);
+    // The indexes mirror the root model, which lists every surface once, whichever sub
+    // container holds it.
+    if (!model()->hasSurface(surface)) {
+        m_surfaceIndex.remove(surface->surface());
+        m_shellSurfaceIndex.remove(surface->shellSurface());
+    }
 }
 
 bool RootSurfaceContainer::filterSurfaceGeometryChanged(SurfaceWrapper *surface,
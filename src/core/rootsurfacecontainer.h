@@ -6,6 +6,8 @@
 
 #include <wglobal.h>
 
+#include <optional>
+
 Q_MOC_INCLUDE(<wcursor.h>)
 
 WAYLIB_SERVER_BEGIN_NAMESPACE
@@ -72,6 +74,9 @@ public:
 
     void beginMoveResize(SurfaceWrapper *surface, Qt::Edges edges);
     void doMoveResize(const QPointF &incrementPos);
+    // Applies the motion still pending for this frame, then ends, for a grab release.
+    void finishMoveResize();
+    // Pending motion is dropped, the surface may be going away.
     void endMoveResize();
     SurfaceWrapper *moveResizeSurface() const;
 
@@ -99,16 +104,21 @@ private:
     bool filterSurfaceStateChange(SurfaceWrapper *surface,
                                   [[maybe_unused]] SurfaceWrapper::State newState,
                                   [[maybe_unused]] SurfaceWrapper::State oldState) override;
+    void updatePolish() override;
 
     void ensureCursorVisible();
     void updateSurfaceOutputs(SurfaceWrapper *surface);
     void ensureSurfaceNormalPositionValid(SurfaceWrapper *surface);
+    void applyMoveResize(const QPointF &incrementPos);
+    bool hasUnackedConfigure(SurfaceWrapper *surface) const;
 
     WOutputLayout *m_outputLayout = nullptr;
     OutputListModel *m_outputModel = nullptr;
     QPointer<Output> m_primaryOutput;
     WCursor *m_cursor = nullptr;
     WSurfaceItem *m_dragSurfaceItem = nullptr;
+    QHash<WSurface *, SurfaceWrapper *> m_surfaceIndex;
+    QHash<WToplevelSurface *, SurfaceWrapper *> m_shellSurfaceIndex;
 
     // for move resize
     struct
@@ -117,6 +127,9 @@ private:
         QRectF startGeometry;
         Qt::Edges resizeEdges;
         bool setSurfacePositionForAnchorEdgets = false;
+        // Latest motion not applied yet, coalesced to one update per frame.
+        std::optional<QPointF> pendingIncrement;
+        QMetaObject::Connection ackConnection;
     } moveResizeState;
 };
 
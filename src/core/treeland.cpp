@@ -10,6 +10,7 @@
 #include "interfaces/multitaskviewinterface.h"
 #include "interfaces/plugininterface.h"
 #include "seat/helper.h"
+#include "seat/inputlatencytracker.h"
 #include "utils/cmdline.h"
 
 #include <qqml.h>
@@ -455,6 +456,23 @@ QString Treeland::XWaylandName()
     return {};
 }
 
+QString Treeland::InputLatency(bool reset)
+{
+    Q_D(Treeland);
+
+    auto tracker = d->helper->inputLatencyTracker();
+    if (!tracker) {
+        sendErrorReply(QDBusError::NotSupported,
+                       "Input latency tracking is disabled, set TREELAND_INPUT_LATENCY to enable");
+        return {};
+    }
+
+    const QString report = tracker->report();
+    if (reset)
+        tracker->reset();
+    return report;
+}
+
 } // namespace Treeland
 
 #include "treeland.moc"
@@ -8,6 +8,10 @@
 
 // The minimum delta required to recognize a swipe gesture
 #define SWIPE_MINIMUM_DELTA 5
+// Only motion within this many milliseconds before release counts towards the velocity
+#define SWIPE_VELOCITY_WINDOW 100
+// Progress per second above which a released swipe commits regardless of its travel
+#define SWIPE_FLING_VELOCITY 1.5
 
 Q_LOGGING_CATEGORY(qLcGestures, "treeland.gestures");
 
@@ -173,6 +177,31 @@ bool SwipeGesture::minimumDeltaReached(const QPointF &delta) const
     return deltaToProgress(delta) >= 1.0;
 }
 
+qreal SwipeGesture::velocityToProgress(const QPointF &velocity) const
+{
+    if (!m_minimumDeltaRelevant && m_minimumDelta.isNull()) {
+        return 0.0;
+    }
+
+    switch (m_direction) {
+    case SwipeGesture::Up:
+        return -velocity.y() / std::abs(m_minimumDelta.y());
+    case SwipeGesture::Down:
+        return velocity.y() / std::abs(m_minimumDelta.y());
+    case SwipeGesture::Left:
+        return -velocity.x() / std::abs(m_minimumDelta.x());
+    case SwipeGesture::Right:
+        return velocity.x() / std::abs(m_minimumDelta.x());
+    default:
+        Q_UNREACHABLE();
+    }
+}
+
+bool SwipeGesture::isFling(qreal progressVelocity)
+{
+    return progressVelocity >= SWIPE_FLING_VELOCITY;
+}
+
 GestureRecognizer::GestureRecognizer(QObject *parent)
     : QObject(parent)
 {
@@ -213,9 +242,12 @@ int GestureRecognizer::startSwipeGesture(const QPointF &startPos)
     return startSwipeGesture(1, startPos, GestureRecognizer::Relevant);
 }
 
-void GestureRecognizer::updateSwipeGesture(const QPointF &delta)
+void GestureRecognizer::updateSwipeGesture(const QPointF &delta, quint64 timestamp)
 {
     m_currentDelta += delta;
+    m_swipeSamples[m_nextSwipeSample] = { delta, timestamp };
+    m_nextSwipeSample = (m_nextSwipeSample + 1) % int(m_swipeSamples.size());
+    m_swipeSampleCount = std::min(m_swipeSampleCount + 1, int(m_swipeSamples.size()));
 
     SwipeGesture::Direction direction;
     Axis swipeAxis;
@@ -279,27 +311,73 @@ void GestureRecognizer::updateSwipeGesture(const QPointF &delta)
 void GestureRecognizer::cancelSwipeGesture()
 {
     cancelSwipeActiveGestures();
+    resetSwipeSamples();
     m_currentFingerCount = 0;
     m_currentDelta = QPointF(0, 0);
     m_currentSwipeAxis = Axis::None;
 }
 
-void GestureRecognizer::endSwipeGesture()
+void GestureRecognizer::endSwipeGesture(quint64 timestamp)
 {
     const QPointF delta = m_currentDelta;
+    const QPointF velocity = swipeVelocity(timestamp);
     for (auto &&gesture : std::as_const(m_activeSwipeGestures)) {
-        if (gesture->minimumDeltaReached(delta)) {
+        const qreal progressVelocity = gesture->velocityToProgress(velocity);
+        Q_EMIT gesture->released(progressVelocity);
+        if (gesture->minimumDeltaReached(delta) || gesture->isFling(progressVelocity)) {
             Q_EMIT gesture->triggered();
         } else {
             Q_EMIT gesture->cancelled();
         }
     }
     m_activeSwipeGestures.clear();
+    resetSwipeSamples();
     m_currentFingerCount = 0;
     m_currentDelta = QPointF(0, 0);
     m_currentSwipeAxis = Axis::None;
 }
 
+void GestureRecognizer::resetSwipeSamples()
+{
+    m_swipeSampleCount = 0;
+    m_nextSwipeSample = 0;
+}
+
+QPointF GestureRecognizer::swipeVelocity(quint64 releaseTime) const
+{
+    if (m_swipeSampleCount < 2) {
+        return QPointF();
+    }
+
+    const int size = m_swipeSamples.size();
+    const auto sampleAt = [this, size](int age) -> const SwipeSample & {
+        return m_swipeSamples[(m_nextSwipeSample + size - 1 - age) % size];
+    };
+
+    const auto &latest = sampleAt(0);
+    if (releaseTime > latest.timestamp && releaseTime - latest.timestamp > SWIPE_VELOCITY_WINDOW) {
+        return QPointF();
+    }
+
+    // Each delta is the motion since the sample before it.
+    QPointF distance;
+    quint64 startTime = latest.timestamp;
+    for (int age = 1; age < m_swipeSampleCount; ++age) {
+        const auto &sample = sampleAt(age);
+        if (sample.timestamp > startTime
+            || latest.timestamp - sample.timestamp > SWIPE_VELOCITY_WINDOW) {
+            break;
+        }
+        distance += sampleAt(age - 1).delta;
+        startTime = sample.timestamp;
+    }
+
+    if (startTime == latest.timestamp) {
+        return QPointF();
+    }
+    return distance * 1000.0 / qreal(latest.timestamp - startTime);
+}
+
 void GestureRecognizer::cancelSwipeActiveGestures()
 {
     for (auto &&gesture : std::as_const(m_activeSwipeGestures)) {
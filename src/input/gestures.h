@@ -10,6 +10,8 @@
 #include <QPointF>
 #include <QTimer>
 
+#include <array>
+
 class Gesture : public QObject
 {
     Q_OBJECT
@@ -69,10 +71,15 @@ public:
 
     qreal deltaToProgress(const QPointF &delta) const;
     bool minimumDeltaReached(const QPointF &delta) const;
+    // Progress per second along the gesture direction, negative when moving back.
+    qreal velocityToProgress(const QPointF &velocity) const;
+    static bool isFling(qreal progressVelocity);
 
 Q_SIGNALS:
     void progress(qreal);
     void deltaProgress(const QPointF &delta);
+    // Emitted before triggered() or cancelled() when the fingers are lifted.
+    void released(qreal progressVelocity);
 
 private:
     bool m_minimumFingerCountRelevant = false;
@@ -139,15 +146,24 @@ public:
     int startSwipeGesture(uint fingerCount);
     int startSwipeGesture(const QPointF &startPos);
 
-    void updateSwipeGesture(const QPointF &delta);
+    void updateSwipeGesture(const QPointF &delta, quint64 timestamp);
     void cancelSwipeGesture();
-    void endSwipeGesture();
+    void endSwipeGesture(quint64 timestamp);
 
     void startHoldGesture(uint fingerCount);
     void endHoldGesture();
 
 private:
+    struct SwipeSample
+    {
+        QPointF delta;
+        quint64 timestamp = 0;
+    };
+
     void cancelSwipeActiveGestures();
+    void resetSwipeSamples();
+    // Pixels per second over the latest samples, null if the fingers rested before release.
+    QPointF swipeVelocity(quint64 releaseTime) const;
     int startSwipeGesture(uint fingerCount,
                           const QPointF &start_pos,
                           StartPositionBehavior behavior);
@@ -159,6 +175,9 @@ private:
     QMap<Gesture *, QMetaObject::Connection> m_destroyConnections;
 
     QPointF m_currentDelta = QPointF(0, 0);
+    std::array<SwipeSample, 8> m_swipeSamples;
+    int m_swipeSampleCount = 0;
+    int m_nextSwipeSample = 0;
     uint m_currentFingerCount = 0;
     GestureRecognizer::Axis m_currentSwipeAxis = GestureRecognizer::None;
 };
@@ -11,10 +11,17 @@
 #include <QInputDevice>
 #include <QLoggingCategory>
 #include <QPointer>
+#include <QTouchEvent>
 
 QW_USE_NAMESPACE
 
 #define MIN_SWIPE_FINGERS 3
+// Touchpad deltas are accelerated libinput units
+#define TOUCHPAD_SWIPE_DELTA 200
+// Part of the touched output a touchscreen swipe has to cross, deltas are in output pixels
+#define TOUCHSCREEN_SWIPE_RATIO 0.2
+// Width of the screen edge area that starts a touchscreen edge swipe
+#define TOUCHSCREEN_EDGE_SIZE 20
 
 Q_LOGGING_CATEGORY(qLcInputdevice, "treeland.inputdevice");
 
@@ -334,6 +341,7 @@ InputDevice *InputDevice::m_instance = nullptr;
 InputDevice::InputDevice(QObject *parent)
     : QObject(parent)
     , m_touchpadRecognizer(new GestureRecognizer(this))
+    , m_touchscreenRecognizer(new GestureRecognizer(this))
 {
 }
 
@@ -362,11 +370,17 @@ bool InputDevice::initTouchPad(WInputDevice *device)
     return false;
 }
 
-void InputDevice::registerTouchpadSwipe(const SwipeFeedBack &feed_back)
+bool InputDevice::initTouchScreen(WInputDevice *device)
+{
+    return device->qtDevice()->type() == QInputDevice::DeviceType::TouchScreen;
+}
+
+SwipeGesture *InputDevice::createSwipeGesture(const SwipeFeedBack &feed_back,
+                                              const QPointF &minimumDelta)
 {
     auto swipe_gesture = new SwipeGesture();
     swipe_gesture->setDirection(feed_back.direction);
-    swipe_gesture->setMinimumDelta(QPointF(200, 200));
+    swipe_gesture->setMinimumDelta(minimumDelta);
     swipe_gesture->setMaximumFingerCount(feed_back.fingerCount);
     swipe_gesture->setMinimumFingerCount(feed_back.fingerCount);
 
@@ -379,7 +393,39 @@ void InputDevice::registerTouchpadSwipe(const SwipeFeedBack &feed_back)
         QObject::connect(swipe_gesture, &SwipeGesture::progress, feed_back.progressCallback);
     }
 
-    m_touchpadRecognizer->registerSwipeGesture(swipe_gesture);
+    if (feed_back.releaseCallback) {
+        QObject::connect(swipe_gesture, &SwipeGesture::released, feed_back.releaseCallback);
+    }
+
+    return swipe_gesture;
+}
+
+void InputDevice::registerTouchpadSwipe(const SwipeFeedBack &feed_back)
+{
+    m_touchpadRecognizer->registerSwipeGesture(
+        createSwipeGesture(feed_back, QPointF(TOUCHPAD_SWIPE_DELTA, TOUCHPAD_SWIPE_DELTA)));
+}
+
+void InputDevice::registerTouchscreenSwipe(const SwipeFeedBack &feed_back)
+{
+    auto swipe_gesture = createSwipeGesture(feed_back, m_touchscreenSwipeDelta);
+    m_touchscreenGestures << swipe_gesture;
+    m_touchscreenRecognizer->registerSwipeGesture(swipe_gesture);
+}
+
+void InputDevice::registerTouchscreenEdgeSwipe(const SwipeFeedBack &feed_back)
+{
+    auto swipe_gesture = createSwipeGesture(SwipeFeedBack{ feed_back.direction,
+                                                           1,
+                                                           feed_back.actionCallback,
+                                                           feed_back.progressCallback,
+                                                           feed_back.releaseCallback },
+                                            m_touchscreenSwipeDelta);
+    // The start area follows the touched output, see processTouchEvent.
+    swipe_gesture->setStartGeometry(QRect(0, 0, 1, 1));
+    m_touchscreenGestures << swipe_gesture;
+    m_touchscreenEdgeGestures << swipe_gesture;
+    m_touchscreenRecognizer->registerSwipeGesture(swipe_gesture);
 }
 
 void InputDevice::registerTouchpadHold(const HoldFeedBack &feed)
@@ -405,10 +451,10 @@ void InputDevice::processSwipeStart(uint finger)
     }
 }
 
-void InputDevice::processSwipeUpdate(const QPointF &delta)
+void InputDevice::processSwipeUpdate(const QPointF &delta, quint64 timestamp)
 {
     if (m_touchpadFingerCount >= MIN_SWIPE_FINGERS) {
-        m_touchpadRecognizer->updateSwipeGesture(delta);
+        m_touchpadRecognizer->updateSwipeGesture(delta, timestamp);
     }
 }
 
@@ -419,10 +465,10 @@ void InputDevice::processSwipeCancel()
     }
 }
 
-void InputDevice::processSwipeEnd()
+void InputDevice::processSwipeEnd(quint64 timestamp)
 {
     if (m_touchpadFingerCount >= MIN_SWIPE_FINGERS) {
-        m_touchpadRecognizer->endSwipeGesture();
+        m_touchpadRecognizer->endSwipeGesture(timestamp);
     }
 }
 
@@ -440,3 +486,105 @@ void InputDevice::processHoldEnd()
         m_touchpadRecognizer->endHoldGesture();
     }
 }
+
+void InputDevice::processTouchEvent(QTouchEvent *event, const QRectF &outputGeometry)
+{
+    if (event->type() == QEvent::TouchCancel) {
+        if (m_touchscreenSwipeActive) {
+            m_touchscreenRecognizer->cancelSwipeGesture();
+        }
+        resetTouchscreenSwipe();
+        return;
+    }
+
+    uint fingerCount = 0;
+    QPointF centroid;
+    for (const auto &point : event->points()) {
+        if (point.state() == QEventPoint::Released) {
+            continue;
+        }
+        centroid += point.globalPosition();
+        fingerCount++;
+    }
+    if (fingerCount > 0) {
+        centroid /= fingerCount;
+    }
+
+    if (event->type() == QEvent::TouchBegin) {
+        resetTouchscreenSwipe();
+        if (outputGeometry.isValid()) {
+            m_touchscreenSwipeDelta = QPointF(outputGeometry.width() * TOUCHSCREEN_SWIPE_RATIO,
+                                              outputGeometry.height() * TOUCHSCREEN_SWIPE_RATIO);
+            for (auto &&gesture : std::as_const(m_touchscreenGestures)) {
+                if (gesture) {
+                    gesture->setMinimumDelta(m_touchscreenSwipeDelta);
+                }
+            }
+        }
+        if (fingerCount == 1 && outputGeometry.isValid()) {
+            const QRect geometry = outputGeometry.toRect();
+            for (auto &&gesture : std::as_const(m_touchscreenEdgeGestures)) {
+                if (!gesture) {
+                    continue;
+                }
+                switch (gesture->direction()) {
+                case SwipeGesture::Up:
+                    gesture->setStartGeometry(
+                        geometry.adjusted(0, geometry.height() - TOUCHSCREEN_EDGE_SIZE, 0, 0));
+                    break;
+                case SwipeGesture::Down:
+                    gesture->setStartGeometry(
+                        geometry.adjusted(0, 0, 0, TOUCHSCREEN_EDGE_SIZE - geometry.height()));
+                    break;
+                case SwipeGesture::Left:
+                    gesture->setStartGeometry(
+                        geometry.adjusted(geometry.width() - TOUCHSCREEN_EDGE_SIZE, 0, 0, 0));
+                    break;
+                case SwipeGesture::Right:
+                    gesture->setStartGeometry(
+                        geometry.adjusted(0, 0, TOUCHSCREEN_EDGE_SIZE - geometry.width(), 0));
+                    break;
+                default:
+                    break;
+                }
+            }
+            m_touchscreenSwipeActive = m_touchscreenRecognizer->startSwipeGesture(centroid) > 0;
+        } else if (fingerCount >= MIN_SWIPE_FINGERS) {
+            // All fingers landed in the same touch frame, later updates keep the count.
+            m_touchscreenSwipeActive = m_touchscreenRecognizer->startSwipeGesture(fingerCount) > 0;
+        }
+    } else if (!m_touchscreenSwipeFinished) {
+        if (event->type() == QEvent::TouchEnd || fingerCount < m_touchscreenFingerCount) {
+            // Lifting any finger ends the gesture, the remaining ones may not move together.
+            if (m_touchscreenSwipeActive) {
+                m_touchscreenRecognizer->endSwipeGesture(event->timestamp());
+            }
+            m_touchscreenSwipeActive = false;
+            m_touchscreenSwipeFinished = true;
+        } else if (fingerCount > m_touchscreenFingerCount) {
+            // Fingers rarely land at once, restart with the new finger count.
+            if (m_touchscreenSwipeActive) {
+                m_touchscreenRecognizer->cancelSwipeGesture();
+            }
+            m_touchscreenSwipeActive = fingerCount >= MIN_SWIPE_FINGERS
+                && m_touchscreenRecognizer->startSwipeGesture(fingerCount) > 0;
+        } else if (m_touchscreenSwipeActive) {
+            m_touchscreenRecognizer->updateSwipeGesture(centroid - m_touchscreenCentroid,
+                                                        event->timestamp());
+        }
+    }
+
+    m_touchscreenFingerCount = fingerCount;
+    m_touchscreenCentroid = centroid;
+    if (event->type() == QEvent::TouchEnd) {
+        resetTouchscreenSwipe();
+    }
+}
+
+void InputDevice::resetTouchscreenSwipe()
+{
+    m_touchscreenCentroid = QPointF();
+    m_touchscreenFingerCount = 0;
+    m_touchscreenSwipeActive = false;
+    m_touchscreenSwipeFinished = false;
+}
@@ -10,6 +10,12 @@
 #include <wglobal.h>
 
 #include <QInputDevice>
+#include <QPointer>
+#include <QRectF>
+
+QT_BEGIN_NAMESPACE
+class QTouchEvent;
+QT_END_NAMESPACE
 
 WAYLIB_SERVER_BEGIN_NAMESPACE
 class WInputDevice;
@@ -23,6 +29,8 @@ struct SwipeFeedBack
     uint fingerCount;
     std::function<void()> actionCallback;
     std::function<void(qreal)> progressCallback;
+    // Receives the release velocity in progress per second along the direction.
+    std::function<void(qreal)> releaseCallback;
 };
 
 struct HoldFeedBack
@@ -41,23 +49,44 @@ public:
     InputDevice &operator=(const InputDevice &) = delete;
 
     bool initTouchPad(WInputDevice *device);
+    bool initTouchScreen(WInputDevice *device);
 
     void registerTouchpadSwipe(const SwipeFeedBack &feed_back);
     void registerTouchpadHold(const HoldFeedBack &feed);
+    void registerTouchscreenSwipe(const SwipeFeedBack &feed_back);
+    // A single finger swipe starting at the edge it moves away from, e.g. Up from the bottom.
+    void registerTouchscreenEdgeSwipe(const SwipeFeedBack &feed_back);
 
     void processSwipeStart(uint finger);
-    void processSwipeUpdate(const QPointF &delta);
+    void processSwipeUpdate(const QPointF &delta, quint64 timestamp);
     void processSwipeCancel();
-    void processSwipeEnd();
+    void processSwipeEnd(quint64 timestamp);
 
     void processHoldStart(uint finger);
     void processHoldEnd();
 
+    // outputGeometry is the output touched first, only needed for TouchBegin.
+    void processTouchEvent(QTouchEvent *event, const QRectF &outputGeometry);
+
 private:
     InputDevice(QObject *parent = nullptr);
     ~InputDevice();
 
+    SwipeGesture *createSwipeGesture(const SwipeFeedBack &feed_back, const QPointF &minimumDelta);
+    void resetTouchscreenSwipe();
+
     static InputDevice *m_instance;
     std::unique_ptr<GestureRecognizer> m_touchpadRecognizer;
     uint m_touchpadFingerCount = 0;
+
+    std::unique_ptr<GestureRecognizer> m_touchscreenRecognizer;
+    QList<QPointer<SwipeGesture>> m_touchscreenGestures;
+    QList<QPointer<SwipeGesture>> m_touchscreenEdgeGestures;
+    // Follows the size of the touched output, see processTouchEvent.
+    QPointF m_touchscreenSwipeDelta{ 200, 200 };
+    QPointF m_touchscreenCentroid;
+    uint m_touchscreenFingerCount = 0;
+    bool m_touchscreenSwipeActive = false;
+    // Set once a finger is lifted, the rest of the touch sequence is ignored.
+    bool m_touchscreenSwipeFinished = false;
 };
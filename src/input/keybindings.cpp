@@ -0,0 +1,125 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "keybindings.h"
+
+#include <QKeySequence>
+#include <QLoggingCategory>
+#include <QMetaEnum>
+
+Q_LOGGING_CATEGORY(qLcKeyBindings, "treeland.keybindings");
+
+namespace {
+struct DefaultBinding
+{
+    KeyBindings::Action action;
+    KeyBindings::Modes modes;
+    QKeyCombination key;
+};
+
+// Actions check their own preconditions, e.g. an activated surface, when dispatched.
+const DefaultBinding DefaultBindings[] = {
+    { KeyBindings::LockScreenShutdown,
+      KeyBindings::NormalMode,
+      Qt::ControlModifier | Qt::AltModifier | Qt::Key_Delete },
+    { KeyBindings::Quit, KeyBindings::AllModes, Qt::MetaModifier | Qt::Key_F12 },
+    { KeyBindings::SwitchToNextWorkspace, KeyBindings::AllModes, Qt::MetaModifier | Qt::Key_Right },
+    { KeyBindings::SwitchToPrevWorkspace, KeyBindings::AllModes, Qt::MetaModifier | Qt::Key_Left },
+    { KeyBindings::SwitchToWorkspace1, KeyBindings::AllModes, Qt::MetaModifier | Qt::Key_1 },
+    { KeyBindings::SwitchToWorkspace2, KeyBindings::AllModes, Qt::MetaModifier | Qt::Key_2 },
+    { KeyBindings::SwitchToWorkspace3, KeyBindings::AllModes, Qt::MetaModifier | Qt::Key_3 },
+    { KeyBindings::SwitchToWorkspace4, KeyBindings::AllModes, Qt::MetaModifier | Qt::Key_4 },
+    { KeyBindings::SwitchToWorkspace5, KeyBindings::AllModes, Qt::MetaModifier | Qt::Key_5 },
+    { KeyBindings::SwitchToWorkspace6, KeyBindings::AllModes, Qt::MetaModifier | Qt::Key_6 },
+    { KeyBindings::ToggleMultitaskView,
+      KeyBindings::NormalMode | KeyBindings::MultitaskviewMode,
+      Qt::MetaModifier | Qt::Key_S },
+#ifndef DISABLE_DDM
+    { KeyBindings::LockScreen, KeyBindings::AllModes, Qt::MetaModifier | Qt::Key_L },
+#endif
+    { KeyBindings::ToggleShowDesktop, KeyBindings::AllModes, Qt::MetaModifier | Qt::Key_D },
+    { KeyBindings::MaximizeWindow, KeyBindings::AllModes, Qt::MetaModifier | Qt::Key_Up },
+    { KeyBindings::CancelMaximizeWindow, KeyBindings::AllModes, Qt::MetaModifier | Qt::Key_Down },
+    { KeyBindings::CloseWindow, KeyBindings::AllModes, Qt::AltModifier | Qt::Key_F4 },
+    { KeyBindings::ShowWindowMenu, KeyBindings::AllModes, Qt::AltModifier | Qt::Key_Space },
+    { KeyBindings::TaskSwitchPrevious, KeyBindings::AllModes, Qt::AltModifier | Qt::Key_Left },
+    { KeyBindings::TaskSwitchNext, KeyBindings::AllModes, Qt::AltModifier | Qt::Key_Right },
+};
+} // namespace
+
+KeyBindings::KeyBindings()
+{
+    compile({});
+}
+
+void KeyBindings::compile(const QVariantMap &overrides)
+{
+    const auto actionEnum = QMetaEnum::fromType<Action>();
+    QHash<int, QList<QKeyCombination>> keys;
+    for (auto it = overrides.cbegin(); it != overrides.cend(); ++it) {
+        bool ok = false;
+        const auto action = static_cast<Action>(actionEnum.keyToValue(it.key().toLatin1(), &ok));
+        if (!ok) {
+            qCWarning(qLcKeyBindings) << "Unknown key binding action" << it.key();
+            continue;
+        }
+
+        auto &actionKeys = keys[action];
+        const auto sequences =
+            QKeySequence::listFromString(it.value().toString(), QKeySequence::PortableText);
+        for (const auto &sequence : sequences) {
+            // Key events are dispatched one combination at a time.
+            if (sequence.count() != 1) {
+                qCWarning(qLcKeyBindings)
+                    << "Ignore key sequence" << sequence << "of" << it.key()
+                    << ", only single key combinations are supported";
+                continue;
+            }
+            actionKeys.append(sequence[0]);
+        }
+    }
+
+    for (auto &dispatch : m_dispatch)
+        dispatch.clear();
+
+    // Explicit rebinds win over defaults, so bind overridden actions first.
+    for (const bool overridden : { true, false }) {
+        for (const auto &binding : DefaultBindings) {
+            if (keys.contains(binding.action) != overridden)
+                continue;
+            const auto actionKeys = overridden ? keys.value(binding.action) : QList{ binding.key };
+            for (int mode = 0; mode < int(m_dispatch.size()); ++mode) {
+                if (!binding.modes.testFlag(static_cast<Mode>(1 << mode)))
+                    continue;
+                for (const auto &key : actionKeys) {
+                    const auto bound = m_dispatch[mode].constFind(key.toCombined());
+                    if (bound != m_dispatch[mode].cend()) {
+                        if (*bound != binding.action) {
+                            qCWarning(qLcKeyBindings)
+                                << "Key" << QKeySequence(key) << "is already bound to"
+                                << actionEnum.valueToKey(*bound) << ", ignore it for"
+                                << actionEnum.valueToKey(binding.action);
+                        }
+                        continue;
+                    }
+                    m_dispatch[mode].insert(key.toCombined(), binding.action);
+                }
+            }
+        }
+    }
+}
+
+std::optional<KeyBindings::Action> KeyBindings::find(int mode, QKeyCombination key) const
+{
+    Q_ASSERT(mode >= 0 && mode < int(m_dispatch.size()));
+    const auto &dispatch = m_dispatch[mode];
+    const auto it = dispatch.constFind(key.toCombined());
+    if (it == dispatch.cend())
+        return std::nullopt;
+    return *it;
+}
+
+bool KeyBindings::bypassesCaptureSelector(Action action)
+{
+    return action == LockScreenShutdown || action == Quit;
+}
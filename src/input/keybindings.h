@@ -0,0 +1,71 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QVariantMap>
+
+#include <array>
+#include <optional>
+
+// Built-in compositor key bindings, compiled into one dispatch map per mode.
+class KeyBindings
+{
+    Q_GADGET
+
+public:
+    // Enumerator names are the action names used in the keyBindings config.
+    enum Action
+    {
+        LockScreenShutdown,
+        Quit,
+        SwitchToNextWorkspace,
+        SwitchToPrevWorkspace,
+        SwitchToWorkspace1,
+        SwitchToWorkspace2,
+        SwitchToWorkspace3,
+        SwitchToWorkspace4,
+        SwitchToWorkspace5,
+        SwitchToWorkspace6,
+        ToggleMultitaskView,
+        LockScreen,
+        ToggleShowDesktop,
+        MaximizeWindow,
+        CancelMaximizeWindow,
+        CloseWindow,
+        ShowWindowMenu,
+        TaskSwitchPrevious,
+        TaskSwitchNext,
+    };
+    Q_ENUM(Action)
+
+    // Same order as Helper::CurrentMode.
+    enum Mode
+    {
+        NormalMode = 0x1,
+        LockScreenMode = 0x2,
+        WindowSwitchMode = 0x4,
+        MultitaskviewMode = 0x8,
+        AllModes = NormalMode | LockScreenMode | WindowSwitchMode | MultitaskviewMode,
+    };
+    Q_DECLARE_FLAGS(Modes, Mode)
+
+    KeyBindings();
+
+    // Rebuilds the dispatch maps from the defaults, replaced per action by overrides.
+    // A key bound by an override is taken away from the default action using it.
+    void compile(const QVariantMap &overrides);
+
+    // mode is the index of the mode in Mode, i.e. a Helper::CurrentMode value.
+    std::optional<Action> find(int mode, QKeyCombination key) const;
+
+    // Actions that still work while a capture selection is in progress.
+    static bool bypassesCaptureSelector(Action action);
+
+private:
+    std::array<QHash<int, Action>, 4> m_dispatch;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(KeyBindings::Modes)
@@ -8,6 +8,8 @@
 #include "workspace/workspace.h"
 #include "workspace/workspaceanimationcontroller.h"
 
+#include <utility>
+
 TogglableGesture::TogglableGesture(QObject *parent)
     : QObject(parent)
 {
@@ -93,6 +95,13 @@ std::function<void(qreal progress)> TogglableGesture::regressCallback()
     };
 }
 
+std::function<void(qreal velocity)> TogglableGesture::releaseCallback(qreal sign)
+{
+    return [this, sign](qreal velocity) {
+        m_releaseVelocity = sign * velocity;
+    };
+}
+
 void TogglableGesture::setProgress(qreal progress)
 {
     if (m_status == Status::Stopped) {
@@ -146,8 +155,10 @@ std::function<void(void)> TogglableGesture::deactivateTriggeredCallback()
 
 void TogglableGesture::activeTriggered()
 {
+    const qreal velocity = std::exchange(m_releaseVelocity, 0);
     if (m_status == Status::Activating) {
-        if (m_partialGestureFactor > 0.5) {
+        if (SwipeGesture::isFling(velocity)
+            || (m_partialGestureFactor > 0.5 && !SwipeGesture::isFling(-velocity))) {
             activate();
             Q_EMIT activated();
         } else {
@@ -159,8 +170,10 @@ void TogglableGesture::activeTriggered()
 
 void TogglableGesture::deactivateTriggered()
 {
+    const qreal velocity = std::exchange(m_releaseVelocity, 0);
     if (m_status == Status::Deactivating) {
-        if (m_partialGestureFactor < 0.5) {
+        if (SwipeGesture::isFling(velocity)
+            || (m_partialGestureFactor < 0.5 && !SwipeGesture::isFling(-velocity))) {
             deactivate();
             Q_EMIT deactivated();
         } else {
@@ -232,6 +245,8 @@ void TogglableGesture::moveSlide(qreal cb)
 
 void TogglableGesture::moveDischarge()
 {
+    // Positive towards the next workspace, like m_desktopOffset.
+    const qreal velocity = std::exchange(m_releaseVelocity, 0);
     if (!m_slideEnable)
         return;
 
@@ -252,11 +267,14 @@ void TogglableGesture::moveDischarge()
     m_fromId = workspace->currentIndex();
     m_toId = 0;
 
-    if (m_desktopOffset > 0.3) {
+    // A fling commits even a short swipe, and a fling back cancels a long one.
+    const bool flingNext = SwipeGesture::isFling(velocity);
+    const bool flingPrev = SwipeGesture::isFling(-velocity);
+    if (m_desktopOffset > 0 && (flingNext || (m_desktopOffset > 0.3 && !flingPrev))) {
         m_toId = m_slideBounce ? m_fromId : m_fromId + 1;
         if (m_toId >= workspace->count())
             return;
-    } else if (m_desktopOffset <= -0.3) {
+    } else if (m_desktopOffset < 0 && (flingPrev || (m_desktopOffset <= -0.3 && !flingNext))) {
         m_toId = m_slideBounce ? m_fromId : m_fromId - 1;
         if (m_toId < 0)
             return;
@@ -267,28 +285,33 @@ void TogglableGesture::moveDischarge()
     auto controller = workspace->animationController();
     if (m_toId >= 0 && m_toId < workspace->count()) {
         controller->slideRunning(m_toId);
-        controller->startSlideAnimation();
+        controller->startSlideAnimation(velocity);
         workspace->setCurrentIndex(m_toId);
     }
 }
 
-void TogglableGesture::addTouchpadSwipeGesture(SwipeGesture::Direction direction, uint finger)
+void TogglableGesture::addSwipeGesture(
+    SwipeGesture::Direction direction,
+    uint finger,
+    const std::function<void(const SwipeFeedBack &)> &registerSwipe)
 {
     if (direction == SwipeGesture::Invalid)
         return;
 
     if (direction == SwipeGesture::Up || direction == SwipeGesture::Down) {
-        InputDevice::instance()->registerTouchpadSwipe(
+        registerSwipe(
             SwipeFeedBack{ direction,
                            finger,
                            this->activeTriggeredCallback(),
-                           this->progressCallback() });
+                           this->progressCallback(),
+                           this->releaseCallback() });
 
-        InputDevice::instance()->registerTouchpadSwipe(
+        registerSwipe(
             SwipeFeedBack{ opposite(direction),
                            finger,
                            this->deactivateTriggeredCallback(),
-                           this->regressCallback() });
+                           this->regressCallback(),
+                           this->releaseCallback() });
     } else {
         const auto left = [this](qreal cb) {
             moveSlide(cb);
@@ -302,14 +325,41 @@ void TogglableGesture::addTouchpadSwipeGesture(SwipeGesture::Direction direction
             moveDischarge();
         };
 
-        InputDevice::instance()->registerTouchpadSwipe(
-            SwipeFeedBack{ SwipeGesture::Left, finger, trigger, left });
+        registerSwipe(
+            SwipeFeedBack{ SwipeGesture::Left, finger, trigger, left, releaseCallback() });
 
-        InputDevice::instance()->registerTouchpadSwipe(
-            SwipeFeedBack{ SwipeGesture::Right, finger, trigger, right });
+        registerSwipe(
+            SwipeFeedBack{ SwipeGesture::Right, finger, trigger, right, releaseCallback(-1.0) });
     }
 }
 
+void TogglableGesture::addTouchpadSwipeGesture(SwipeGesture::Direction direction, uint finger)
+{
+    addSwipeGesture(direction, finger, [](const SwipeFeedBack &feed_back) {
+        InputDevice::instance()->registerTouchpadSwipe(feed_back);
+    });
+}
+
+void TogglableGesture::addTouchscreenSwipeGesture(SwipeGesture::Direction direction, uint finger)
+{
+    addSwipeGesture(direction, finger, [](const SwipeFeedBack &feed_back) {
+        InputDevice::instance()->registerTouchscreenSwipe(feed_back);
+    });
+}
+
+void TogglableGesture::addTouchscreenEdgeSwipeGesture(SwipeGesture::Direction direction)
+{
+    if (direction == SwipeGesture::Invalid)
+        return;
+
+    InputDevice::instance()->registerTouchscreenEdgeSwipe(
+        SwipeFeedBack{ direction,
+                       1,
+                       this->activeTriggeredCallback(),
+                       this->progressCallback(),
+                       this->releaseCallback() });
+}
+
 void TogglableGesture::addTouchpadHoldGesture(uint finger)
 {
     const auto pressed = [this]() {
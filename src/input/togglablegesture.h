@@ -7,6 +7,8 @@
 
 #include <QObject>
 
+struct SwipeFeedBack;
+
 class TogglableGesture : public QObject
 {
     Q_OBJECT
@@ -53,6 +55,8 @@ public:
 
     void addTouchpadSwipeGesture(SwipeGesture::Direction direction, uint fingerCount);
     void addTouchpadHoldGesture(uint fingerCount);
+    void addTouchscreenSwipeGesture(SwipeGesture::Direction direction, uint fingerCount);
+    void addTouchscreenEdgeSwipeGesture(SwipeGesture::Direction direction);
 
 Q_SIGNALS:
     void inProgressChanged();
@@ -66,6 +70,7 @@ Q_SIGNALS:
 protected:
     std::function<void(qreal progress)> progressCallback();
     std::function<void(qreal progress)> regressCallback();
+    std::function<void(qreal velocity)> releaseCallback(qreal sign = 1.0);
     void setProgress(qreal progress);
     void setRegress(qreal regress);
     void moveSlide(qreal cb);
@@ -77,10 +82,16 @@ protected:
     void deactivateTriggered();
 
 private:
+    void addSwipeGesture(SwipeGesture::Direction direction,
+                         uint fingerCount,
+                         const std::function<void(const SwipeFeedBack &)> &registerSwipe);
+
     Status m_status = Status::Inactive;
     bool m_inProgress = false;
     qreal m_partialGestureFactor;
     qreal m_desktopOffset;
+    // Signed release velocity of the gesture being finished, in progress per second.
+    qreal m_releaseVelocity = 0;
     int m_fromId = 0;
     int m_toId = 0;
     bool m_slideEnable = false;
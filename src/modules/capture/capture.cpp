@@ -11,6 +11,7 @@
 
 #include <private/qquickitem_p.h>
 
+#include <wcursor.h>
 #include <wlayersurface.h>
 #include <woutputitem.h>
 #include <woutputrenderwindow.h>
@@ -22,14 +23,27 @@
 #include <qwcompositor.h>
 #include <qwdisplay.h>
 #include <qwlayershellv1.h>
+#include <qwoutput.h>
 
+#include <QFuture>
 #include <QLoggingCategory>
 #include <QQueue>
 #include <QQuickItemGrabResult>
 #include <QSGTextureProvider>
 
+#include <algorithm>
 #include <utility>
 
+#include <sys/time.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+extern "C" {
+#include <wlr/types/wlr_output.h>
+}
+
 Q_LOGGING_CATEGORY(qLcCapture, "treeland.capture")
 
 static inline QRectF scaledRect(const QRectF &rect, qreal devicePixelRatio)
@@ -40,6 +54,103 @@ static inline QRectF scaledRect(const QRectF &rect, qreal devicePixelRatio)
              rect.height() * devicePixelRatio };
 }
 
+static inline QRegion regionFromPixman(const pixman_region32_t *region)
+{
+    int count = 0;
+    auto rects = pixman_region32_rectangles(const_cast<pixman_region32_t *>(region), &count);
+    QRegion result;
+    for (int i = 0; i < count; ++i) {
+        result += QRect(QPoint(rects[i].x1, rects[i].y1), QPoint(rects[i].x2 - 1, rects[i].y2 - 1));
+    }
+    return result;
+}
+
+// Damage of an output commit in output buffer coordinates, empty if no new buffer is committed.
+static inline QRegion outputCommitDamage(const wlr_output_event_commit *event)
+{
+    const auto *state = event->state;
+    if (!(state->committed & WLR_OUTPUT_STATE_BUFFER) || !state->buffer)
+        return {};
+    if (state->committed & WLR_OUTPUT_STATE_DAMAGE)
+        return regionFromPixman(&state->damage);
+    return QRect(0, 0, state->buffer->width, state->buffer->height);
+}
+
+// 32 bits pixel layouts that can be converted to each other by swizzling channels.
+struct PixelLayout
+{
+    enum Order
+    {
+        Unknown,
+        Argb, // 0xAARRGGBB in native endian, aka DRM_FORMAT_[AX]RGB8888
+        Abgr, // 0xAABBGGRR in native endian, aka DRM_FORMAT_[AX]BGR8888
+    };
+
+    Order order{ Unknown };
+    bool premultiplied{ false };
+    bool opaque{ false };
+};
+
+static inline PixelLayout pixelLayout(QImage::Format format)
+{
+    switch (format) {
+    case QImage::Format_RGB32:
+        return { PixelLayout::Argb, false, true };
+    case QImage::Format_ARGB32:
+        return { PixelLayout::Argb, false, false };
+    case QImage::Format_ARGB32_Premultiplied:
+        return { PixelLayout::Argb, true, false };
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    case QImage::Format_RGBX8888:
+        return { PixelLayout::Abgr, false, true };
+    case QImage::Format_RGBA8888:
+        return { PixelLayout::Abgr, false, false };
+    case QImage::Format_RGBA8888_Premultiplied:
+        return { PixelLayout::Abgr, true, false };
+#endif
+    default:
+        return {};
+    }
+}
+
+static inline uint32_t swizzlePixel(uint32_t pixel, bool swapRB, uint32_t alphaMask)
+{
+    if (swapRB) {
+        const uint32_t rb = pixel & 0x00ff00ff;
+        pixel = (pixel & 0xff00ff00) | (rb << 16) | (rb >> 16);
+    }
+    return pixel | alphaMask;
+}
+
+// Convert one row of pixels, swapping red and blue channels if needed and forcing alpha
+// for opaque destinations. Source and destination must not overlap.
+static void swizzleRow(const uint32_t *src, uint32_t *dst, int count, bool swapRB, bool opaque)
+{
+    const uint32_t alphaMask = opaque ? 0xff000000 : 0;
+    if (!swapRB && !alphaMask) {
+        memcpy(dst, src, count * sizeof(uint32_t));
+        return;
+    }
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i agMask = _mm_set1_epi32(0xff00ff00);
+    const __m128i rbMask = _mm_set1_epi32(0x00ff00ff);
+    const __m128i alpha = _mm_set1_epi32(alphaMask);
+    for (; i + 4 <= count; i += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        if (swapRB) {
+            const __m128i rb = _mm_and_si128(pixels, rbMask);
+            pixels = _mm_or_si128(_mm_and_si128(pixels, agMask),
+                                  _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16)));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_or_si128(pixels, alpha));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = swizzlePixel(src[i], swapRB, alphaMask);
+    }
+}
+
 CaptureSource *CaptureContextV1::source() const
 {
     return m_captureSource;
@@ -98,7 +209,12 @@ bool CaptureContextV1::freeze() const
 
 bool CaptureContextV1::withCursor() const
 {
-    return m_handle->withCursor;
+    return cursorMode() == CursorEmbedded;
+}
+
+CaptureContextV1::CursorMode CaptureContextV1::cursorMode() const
+{
+    return static_cast<CursorMode>(qMin<uint32_t>(m_handle->cursorMode, CursorMetadata));
 }
 
 CaptureSource::CaptureSourceHint CaptureContextV1::sourceHint() const
@@ -112,12 +228,21 @@ CaptureContextV1::CaptureContextV1(treeland_capture_context_v1 *h,
     : QObject(parent)
     , m_handle(h)
     , m_outputRenderWindow(outputRenderWindow)
+    , m_frameTimer(new QTimer(this))
 {
+    m_frameTimer->setSingleShot(true);
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_frameTimer, &QTimer::timeout, this, &CaptureContextV1::trySendFrame);
     connect(h, &treeland_capture_context_v1::selectSource, this, &CaptureContextV1::onSelectSource);
     connect(h, &treeland_capture_context_v1::capture, this, &CaptureContextV1::onCapture);
     connect(h, &treeland_capture_context_v1::newSession, this, &CaptureContextV1::onCreateSession);
 }
 
+CaptureContextV1::~CaptureContextV1()
+{
+    releaseFrameRing();
+}
+
 void CaptureContextV1::onSelectSource()
 {
     auto context = qobject_cast<treeland_capture_context_v1 *>(sender());
@@ -199,11 +324,18 @@ void CaptureContextV1::onCreateSession(treeland_capture_session_v1 *session)
             &treeland_capture_session_v1::frameDone,
             this,
             &CaptureContextV1::handleFrameDone);
+    connect(m_session,
+            &treeland_capture_session_v1::maxFrameRateRequested,
+            this,
+            &CaptureContextV1::setMaxFrameRate);
     connect(m_session, &treeland_capture_session_v1::beforeDestroy, this, [this] {
         disconnect(outputRenderWindow(),
                    &WOutputRenderWindow::renderEnd,
                    this,
                    &CaptureContextV1::handleRenderEnd);
+        releaseFrameRing();
+        if (m_cursorTracker)
+            m_cursorTracker->deleteLater();
     });
     ensureSourceSessionConnection();
     Q_EMIT finishSelect();
@@ -236,7 +368,34 @@ void CaptureContextV1::handleSourceDestroyed()
 
 void CaptureContextV1::handleSessionStart()
 {
-    m_currentFrameData.acked = true;
+    releaseFrameRing();
+    m_frameRing = QList<FrameData>(qMax(m_frameRingSize, 1u));
+    for (auto &frame : m_frameRing) {
+        frame.acked = true;
+    }
+    m_droppedFrames = 0;
+    m_fullDamage = true;
+    m_pendingDamage = {};
+    connect(captureSource(),
+            &CaptureSource::damaged,
+            this,
+            &CaptureContextV1::handleSourceDamaged,
+            Qt::UniqueConnection);
+    captureSource()->startDamageTracking();
+    if (cursorMode() == CursorMetadata && session()->canSendCursor() && !m_cursorTracker) {
+        // Tracker stays in GUI thread with the cursor items.
+        m_cursorTracker = new CaptureCursorTracker(outputRenderWindow());
+        connect(m_cursorTracker,
+                &CaptureCursorTracker::positionChanged,
+                this,
+                &CaptureContextV1::handleCursorPosition);
+        connect(m_cursorTracker,
+                &CaptureCursorTracker::imageChanged,
+                this,
+                &CaptureContextV1::handleCursorImage);
+        connect(this, &QObject::destroyed, m_cursorTracker, &QObject::deleteLater);
+        m_cursorTracker->refresh();
+    }
     moveToThread(QQuickWindowPrivate::get(outputRenderWindow())->context->thread());
     captureSource()->moveToThread(
         QQuickWindowPrivate::get(outputRenderWindow())->context->thread());
@@ -255,15 +414,53 @@ void CaptureContextV1::handleSessionStart()
 
 void CaptureContextV1::handleFrameDone(uint32_t tvSecHi, uint32_t tvSecLo, uint32_t tvUsec)
 {
-    if (m_currentFrameData.readyAt.tvSecHi == tvSecHi
-        && m_currentFrameData.readyAt.tvSecLo == tvSecLo
-        && m_currentFrameData.readyAt.tvUsec == tvUsec) {
-        // Note: dmabuf attributes is exported from output backing buffer, fds will be
-        // closed as soon as backing buffer is destroyed. We should not close fd here.
-        m_currentFrameData.acked = true;
-    } else {
+    auto it = std::find_if(m_frameRing.begin(), m_frameRing.end(), [&](const FrameData &frame) {
+        return !frame.acked && frame.readyAt.tvSecHi == tvSecHi
+            && frame.readyAt.tvSecLo == tvSecLo && frame.readyAt.tvUsec == tvUsec;
+    });
+    if (it == m_frameRing.end()) {
         qCWarning(qLcCapture())
-            << "Receive a frame done event that is not corresponding to current frame timestamp.";
+            << "Receive a frame done event that is not corresponding to any frame in flight.";
+        return;
+    }
+    // Note: dmabuf attributes is exported from output backing buffer, fds will be
+    // closed as soon as backing buffer is destroyed. We should not close fd here.
+    releaseFrame(*it);
+    // Damage reported while all slots are busy has already been rendered, no need
+    // to wait for another render to deliver it.
+    if (!m_pendingDamage.isEmpty())
+        QMetaObject::invokeMethod(this, &CaptureContextV1::trySendFrame, Qt::QueuedConnection);
+}
+
+uint CaptureContextV1::frameRingSize() const
+{
+    return m_frameRingSize;
+}
+
+void CaptureContextV1::setFrameRingSize(uint size)
+{
+    m_frameRingSize = qBound(1u, size, CaptureContextV1::MaxFrameRingSize);
+}
+
+quint64 CaptureContextV1::droppedFrames() const
+{
+    return m_droppedFrames;
+}
+
+uint CaptureContextV1::maxFrameRate() const
+{
+    return m_maxFrameRate;
+}
+
+void CaptureContextV1::setMaxFrameRate(uint fps)
+{
+    if (m_maxFrameRate == fps)
+        return;
+    m_maxFrameRate = fps;
+    m_nextFrameDeadline = {};
+    if (!m_maxFrameRate && m_frameTimer->isActive()) {
+        m_frameTimer->stop();
+        trySendFrame();
     }
 }
 
@@ -282,10 +479,64 @@ QPointer<WOutputRenderWindow> CaptureContextV1::outputRenderWindow() const
     return m_outputRenderWindow;
 }
 
+void CaptureContextV1::handleSourceDamaged(const QRegion &region)
+{
+    m_pendingDamage += region;
+}
+
+void CaptureContextV1::handleCursorPosition(const QPointF &scenePosition)
+{
+    if (!session() || !captureSource())
+        return;
+    // Pointer motion only costs an event, no new frame is needed.
+    const QPoint position = captureSource()->mapFromScene(scenePosition).toPoint();
+    if (position == m_lastCursorPosition)
+        return;
+    m_lastCursorPosition = position;
+    session()->sendCursorPosition(position);
+}
+
+void CaptureContextV1::handleCursorImage(const QImage &image, const QPointF &hotSpot)
+{
+    if (!session())
+        return;
+    session()->sendCursorImage(image, hotSpot.toPoint());
+}
+
 void CaptureContextV1::handleRenderEnd()
 {
-    if (!session() || !m_currentFrameData.acked)
+    if (!session())
+        return;
+    // Nothing changed since last frame, don't bother client.
+    if (!m_fullDamage && m_pendingDamage.isEmpty())
+        return;
+    gettimeofday(&m_renderedAt.tv, nullptr);
+    trySendFrame();
+}
+
+void CaptureContextV1::trySendFrame()
+{
+    if (!session() || (!m_fullDamage && m_pendingDamage.isEmpty()))
+        return;
+    const auto now = std::chrono::steady_clock::now();
+    if (m_maxFrameRate && now < m_nextFrameDeadline) {
+        // Too early, coalesce with the following renders and send when deadline is reached.
+        if (!m_frameTimer->isActive()) {
+            m_frameTimer->start(std::chrono::ceil<std::chrono::milliseconds>(
+                m_nextFrameDeadline - now));
+        }
+        return;
+    }
+    auto slot = std::find_if(m_frameRing.begin(), m_frameRing.end(), [](const FrameData &frame) {
+        return frame.acked;
+    });
+    if (slot == m_frameRing.end()) {
+        // Client is too slow, drop this frame and keep its damage for the next free slot.
+        ++m_droppedFrames;
+        qCDebug(qLcCapture()) << "All" << m_frameRing.size()
+                              << "frame slots are in flight, dropped frames:" << m_droppedFrames;
         return;
+    }
     auto source = captureSource();
     Q_ASSERT(source);
     auto dmabuf = source->sourceDMABuffer();
@@ -293,8 +544,19 @@ void CaptureContextV1::handleRenderEnd()
         qCWarning(qLcCapture()) << "Source has been invalid while connection still exists.";
         return;
     }
-    m_currentFrameData = {};
-    dmabuf->get_dmabuf(&m_currentFrameData.attribs);
+    if (m_maxFrameRate) {
+        // Keep a steady cadence, but don't try to catch up frames that are long overdue.
+        const std::chrono::microseconds interval(1000000 / m_maxFrameRate);
+        m_nextFrameDeadline = now - m_nextFrameDeadline < interval ? m_nextFrameDeadline + interval
+                                                                    : now + interval;
+    }
+    FrameData &frame = *slot;
+    frame = {};
+    dmabuf->get_dmabuf(&frame.attribs);
+    // All slots alias the swapchain buffers of the output, keep this one out of the
+    // swapchain until client is done with it.
+    frame.buffer = dmabuf;
+    frame.buffer->lock();
 
     union
     {
@@ -305,36 +567,183 @@ void CaptureContextV1::handleRenderEnd()
             uint32_t mod_low;
             uint32_t mod_high;
         };
-    } modifierUnion(m_currentFrameData.attribs.modifier);
+    } modifierUnion(frame.attribs.modifier);
 
-    qInfo() << "session:" << session();
-    qInfo() << "session resource:" << session()->resource;
     treeland_capture_session_v1_send_frame(session()->resource,
                                            source->cropRect().x(),
                                            source->cropRect().y(),
-                                           m_currentFrameData.attribs.width,
-                                           m_currentFrameData.attribs.height,
+                                           frame.attribs.width,
+                                           frame.attribs.height,
                                            0,
                                            0,
-                                           m_currentFrameData.attribs.format,
+                                           frame.attribs.format,
                                            modifierUnion.mod_high,
                                            modifierUnion.mod_low,
-                                           m_currentFrameData.attribs.n_planes);
-    for (auto i = 0; i < m_currentFrameData.attribs.n_planes; ++i) {
+                                           frame.attribs.n_planes);
+    for (auto i = 0; i < frame.attribs.n_planes; ++i) {
         treeland_capture_session_v1_send_object(session()->resource,
                                                 i,
-                                                m_currentFrameData.attribs.fd[i],
-                                                m_currentFrameData.attribs.stride[i]
-                                                    * m_currentFrameData.attribs.height,
-                                                m_currentFrameData.attribs.offset[i],
-                                                m_currentFrameData.attribs.stride[i],
+                                                frame.attribs.fd[i],
+                                                frame.attribs.stride[i] * frame.attribs.height,
+                                                frame.attribs.offset[i],
+                                                frame.attribs.stride[i],
                                                 i);
     }
-    gettimeofday(&m_currentFrameData.readyAt.tv, nullptr);
+    const QRect bufferRect(0, 0, frame.attribs.width, frame.attribs.height);
+    const QRegion damage = m_fullDamage ? QRegion(bufferRect) : m_pendingDamage & bufferRect;
+    for (const auto &rect : damage) {
+        session()->sendDamage(rect);
+    }
+    m_pendingDamage = {};
+    m_fullDamage = false;
+    // Stamp with the render that produced the content rather than the time it's sent.
+    frame.readyAt = m_renderedAt;
+    // Timestamp identifies the slot in frame_done, keep it unique among frames in flight.
+    if (!timercmp(&frame.readyAt.tv, &m_lastReadyAt.tv, >)) {
+        const timeval oneUsec{ 0, 1 };
+        timeradd(&m_lastReadyAt.tv, &oneUsec, &frame.readyAt.tv);
+    }
+    m_lastReadyAt = frame.readyAt;
     treeland_capture_session_v1_send_ready(session()->resource,
-                                           m_currentFrameData.readyAt.tvSecHi,
-                                           m_currentFrameData.readyAt.tvSecLo,
-                                           m_currentFrameData.readyAt.tvUsec);
+                                           frame.readyAt.tvSecHi,
+                                           frame.readyAt.tvSecLo,
+                                           frame.readyAt.tvUsec);
+}
+
+void CaptureContextV1::releaseFrame(FrameData &frame)
+{
+    if (frame.buffer) {
+        frame.buffer->unlock();
+        frame.buffer = nullptr;
+    }
+    frame.acked = true;
+}
+
+void CaptureContextV1::releaseFrameRing()
+{
+    for (auto &frame : m_frameRing)
+        releaseFrame(frame);
+}
+
+CaptureCursorTracker::CaptureCursorTracker(WOutputRenderWindow *renderWindow)
+    : QObject(renderWindow)
+    , m_renderWindow(renderWindow)
+{
+    updateCursorItems();
+}
+
+void CaptureCursorTracker::refresh()
+{
+    m_lastImage = {};
+    updatePosition();
+    updateImage();
+}
+
+void CaptureCursorTracker::updateCursorItems()
+{
+    for (const auto &item : std::as_const(m_cursorItems)) {
+        if (item)
+            item->disconnect(this);
+    }
+    m_cursorItems.clear();
+    if (m_cursor)
+        m_cursor->disconnect(this);
+    m_cursor = nullptr;
+    if (!m_renderWindow)
+        return;
+    QQueue<QQuickItem *> nodes;
+    nodes.enqueue(m_renderWindow->contentItem());
+    while (!nodes.isEmpty()) {
+        auto node = nodes.dequeue();
+        if (auto cursor = qobject_cast<WQuickCursor *>(node)) {
+            m_cursorItems.append(cursor);
+            connect(cursor, &QQuickItem::xChanged, this, &CaptureCursorTracker::updatePosition);
+            connect(cursor, &QQuickItem::yChanged, this, &CaptureCursorTracker::updatePosition);
+            connect(cursor, &QQuickItem::visibleChanged, this, &CaptureCursorTracker::refresh);
+            connect(cursor,
+                    &WQuickCursor::hotSpotChanged,
+                    this,
+                    &CaptureCursorTracker::updateImage);
+            connect(cursor, &QQuickItem::widthChanged, this, &CaptureCursorTracker::updateImage);
+            connect(cursor, &QQuickItem::heightChanged, this, &CaptureCursorTracker::updateImage);
+            if (!m_cursor)
+                m_cursor = cursor->cursor();
+            continue;
+        }
+        nodes.append(node->childItems());
+    }
+    if (!m_cursor)
+        return;
+    // A new shape doesn't have to change the size or hot spot of the cursor item,
+    // follow the shape itself.
+    connect(m_cursor, &WCursor::cursorChanged, this, &CaptureCursorTracker::updateImage);
+    connect(m_cursor,
+            &WCursor::requestedCursorShapeChanged,
+            this,
+            &CaptureCursorTracker::updateImage);
+    connect(m_cursor,
+            &WCursor::requestedCursorSurfaceChanged,
+            this,
+            &CaptureCursorTracker::updateCursorSurface);
+    connect(m_cursor,
+            &WCursor::requestedCursorSurfaceChanged,
+            this,
+            &CaptureCursorTracker::updateImage);
+    updateCursorSurface();
+}
+
+void CaptureCursorTracker::updateCursorSurface()
+{
+    disconnect(m_cursorSurfaceCommit);
+    // Client cursors change their image by committing new buffers to the same surface.
+    if (m_cursor && m_cursor->requestedCursorSurface()) {
+        m_cursorSurfaceCommit = connect(m_cursor->requestedCursorSurface()->handle(),
+                                        &qw_surface::notify_commit,
+                                        this,
+                                        &CaptureCursorTracker::updateImage);
+    }
+}
+
+QQuickItem *CaptureCursorTracker::activeCursor() const
+{
+    for (const auto &item : std::as_const(m_cursorItems)) {
+        if (item && item->isVisible())
+            return item;
+    }
+    return nullptr;
+}
+
+void CaptureCursorTracker::updatePosition()
+{
+    auto cursor = qobject_cast<WQuickCursor *>(activeCursor());
+    if (!cursor) {
+        // Cursor items are created per output, the pointer may be on a new one.
+        updateCursorItems();
+        cursor = qobject_cast<WQuickCursor *>(activeCursor());
+        if (!cursor)
+            return;
+    }
+    Q_EMIT positionChanged(cursor->mapToScene(QPointF(cursor->hotSpot())));
+}
+
+void CaptureCursorTracker::updateImage()
+{
+    auto cursor = qobject_cast<WQuickCursor *>(activeCursor());
+    if (!cursor || cursor->size().isEmpty())
+        return;
+    const QPointF hotSpot = QPointF(cursor->hotSpot());
+    auto result = cursor->grabToImage();
+    if (!result)
+        return;
+    connect(result.data(), &QQuickItemGrabResult::ready, this, [this, result, hotSpot] {
+        const QImage image = result->image();
+        // Only notify when the shape really changed.
+        if (image.isNull() || (image == m_lastImage && hotSpot == m_lastHotSpot))
+            return;
+        m_lastImage = image;
+        m_lastHotSpot = hotSpot;
+        Q_EMIT imageChanged(image, hotSpot * image.devicePixelRatio());
+    });
 }
 
 CaptureManagerV1::CaptureManagerV1(QObject *parent)
@@ -342,6 +751,7 @@ CaptureManagerV1::CaptureManagerV1(QObject *parent)
     , m_manager(nullptr)
     , m_captureContextModel(new CaptureContextModel(this))
     , m_contextInSelection(nullptr)
+    , m_selector(nullptr)
 {
 }
 
@@ -350,6 +760,7 @@ void CaptureManagerV1::setSelector(CaptureSourceSelector *selector)
     if (selector == m_selector)
         return;
     m_selector = selector;
+    attachFreezeSnapshots();
     Q_EMIT selectorChanged();
 }
 
@@ -366,6 +777,16 @@ void CaptureManagerV1::setOutputRenderWindow(WOutputRenderWindow *renderWindow)
     m_outputRenderWindow = renderWindow;
 }
 
+uint CaptureManagerV1::frameRingSize() const
+{
+    return m_frameRingSize;
+}
+
+void CaptureManagerV1::setFrameRingSize(uint size)
+{
+    m_frameRingSize = qBound(1u, size, CaptureContextV1::MaxFrameRingSize);
+}
+
 QByteArrayView CaptureManagerV1::interfaceName() const
 {
     return treeland_capture_manager_v1_interface.name;
@@ -389,6 +810,7 @@ void CaptureManagerV1::create(WServer *server)
             this,
             [this](treeland_capture_context_v1 *context) {
                 auto quickContext = new CaptureContextV1(context, outputRenderWindow(), this);
+                quickContext->setFrameRingSize(frameRingSize());
                 m_captureContextModel->addContext(quickContext);
                 connect(context,
                         &treeland_capture_context_v1::beforeDestroy,
@@ -420,7 +842,9 @@ void CaptureManagerV1::onCaptureContextSelectSource()
     }
     m_contextInSelection = context;
     if (context->freeze()) {
+        // The selector is shown once the snapshots cover the live scene.
         freezeAllCapturedSurface(true, context->mask());
+        return;
     }
     Q_EMIT contextInSelectionChanged();
 }
@@ -449,21 +873,30 @@ WSurfaceItem *closestSurfaceItem(QQuickItem *content)
 
 void CaptureManagerV1::freezeAllCapturedSurface(bool freeze, WSurface *mask)
 {
-    // Exclude cursor surface item and the mask
+    if (!freeze) {
+        releaseFreezeSnapshots();
+        return;
+    }
+    // Collect outputs to snapshot, keep cursor and the mask out of snapshots
     Q_ASSERT(m_outputRenderWindow);
+    // A selected window is grabbed from its own surface item, which must hold the
+    // frozen buffer too.
+    const auto sourceHint = m_contextInSelection->sourceHint();
+    const bool freezeSurfaces = sourceHint.toInt() == 0
+        || sourceHint.testAnyFlags({ CaptureSource::Surface | CaptureSource::Window });
+    QList<WOutputItem *> outputItems;
+    QList<QQuickItem *> excludedItems;
     QQueue<QQuickItem *> nodes;
     nodes.enqueue(m_outputRenderWindow->contentItem());
     while (!nodes.isEmpty()) {
         auto node = nodes.dequeue();
-        if (auto content = qobject_cast<WSurfaceItemContent *>(node)) {
+        if (auto outputItem = qobject_cast<WOutputItem *>(node)) {
+            outputItems.append(outputItem);
+        } else if (auto content = qobject_cast<WSurfaceItemContent *>(node)) {
             if (auto cursor = qobject_cast<WQuickCursor *>(node->parentItem())) {
-                if (freeze)
-                    m_frozenCursorPos = cursor->position(); // Just store position for cursor
-            } else if (!mask
-                       || (content->surface() != mask
-                           && !mask->subsurfaces().contains(content->surface()))) {
-                content->setLive(!freeze);
-            } else if (content->surface() == mask) {
+                m_frozenCursorPos = cursor->position(); // Just store position for cursor
+                excludedItems.append(cursor);
+            } else if (mask && content->surface() == mask) {
                 auto surfaceItem = closestSurfaceItem(content);
                 m_maskSurfaceWrapper = qobject_cast<SurfaceWrapper *>(surfaceItem->parentItem());
                 if (m_maskSurfaceWrapper) {
@@ -474,6 +907,12 @@ void CaptureManagerV1::freezeAllCapturedSurface(bool freeze, WSurface *mask)
                     m_maskSurfaceWrapper->setPositionAutomatic(false);
                 }
                 m_maskShellSurface = surfaceItem->shellSurface();
+                excludedItems.append(content);
+            } else if (mask && mask->subsurfaces().contains(content->surface())) {
+                excludedItems.append(content);
+            } else if (freezeSurfaces) {
+                content->setLive(false);
+                m_frozenContents.append(content);
             }
         }
         auto childItems = node->childItems();
@@ -481,6 +920,119 @@ void CaptureManagerV1::freezeAllCapturedSurface(bool freeze, WSurface *mask)
             nodes.enqueue(child);
         }
     }
+    takeFreezeSnapshots(outputItems, excludedItems);
+}
+
+void CaptureManagerV1::takeFreezeSnapshots(const QList<WOutputItem *> &outputItems,
+                                           const QList<QQuickItem *> &excludedItems)
+{
+    // Snapshot whole outputs, so clients whose windows can't be selected get their
+    // buffers released and keep rendering under the snapshot.
+    restoreFreezeExcludedItems();
+    const quint64 serial = ++m_freezeSerial;
+    for (auto item : excludedItems) {
+        m_freezeExcludedItems.append({ item, item->opacity() });
+        item->setOpacity(0);
+    }
+    QList<QFuture<QImage>> grabs;
+    QList<QPointer<CaptureFreezeSnapshot>> snapshots;
+    for (auto outputItem : outputItems) {
+        auto viewport = outputItem->property("screenViewport").value<WOutputViewport *>();
+        if (!viewport)
+            continue;
+        auto snapshot = new CaptureFreezeSnapshot(m_outputRenderWindow->contentItem());
+        snapshot->setVisible(false);
+        m_freezeSnapshots.append({ outputItem, snapshot });
+        snapshots.append(snapshot);
+        auto grabber =
+            new WTextureCapturer(static_cast<WTextureProviderProvider *>(viewport), snapshot);
+        grabs.append(grabber->grabToImage());
+    }
+    attachFreezeSnapshots();
+    // Excluded items are also restored by releaseFreezeSnapshots, in case the freeze
+    // ends before the grabs do.
+    QtFuture::whenAll(grabs.begin(), grabs.end())
+        .then(this,
+              [this, serial, snapshots](const QList<QFuture<QImage>> &results) {
+                  if (serial != m_freezeSerial)
+                      return;
+                  restoreFreezeExcludedItems();
+                  for (qsizetype i = 0; i < results.size(); ++i) {
+                      if (snapshots[i])
+                          snapshots[i]->setImage(results[i].result());
+                  }
+                  Q_EMIT contextInSelectionChanged();
+              })
+        .onFailed(this, [this, serial](const std::exception &e) {
+            qCCritical(qLcCapture) << e.what();
+            if (serial != m_freezeSerial)
+                return;
+            // Still let the user select, on the live scene.
+            restoreFreezeExcludedItems();
+            Q_EMIT contextInSelectionChanged();
+        });
+}
+
+void CaptureManagerV1::attachFreezeSnapshots()
+{
+    // Stack snapshots right under the selector's content, above all windows.
+    QQuickItem *parent = m_selector;
+    if (!parent && m_outputRenderWindow)
+        parent = m_outputRenderWindow->contentItem();
+    if (!parent)
+        return;
+    for (const auto &[outputItem, snapshot] : std::as_const(m_freezeSnapshots)) {
+        if (!outputItem || !snapshot)
+            continue;
+        snapshot->setParentItem(parent);
+        snapshot->setZ(parent == m_selector ? -1 : 0);
+        const QRectF rect = parent->mapRectFromItem(outputItem, outputItem->boundingRect());
+        snapshot->setPosition(rect.topLeft());
+        snapshot->setSize(rect.size());
+    }
+}
+
+void CaptureManagerV1::releaseFreezeSnapshots()
+{
+    for (const auto &[outputItem, snapshot] : std::as_const(m_freezeSnapshots)) {
+        if (snapshot)
+            snapshot->deleteLater();
+    }
+    m_freezeSnapshots.clear();
+    ++m_freezeSerial;
+    restoreFreezeExcludedItems();
+    for (const auto &content : std::as_const(m_frozenContents)) {
+        if (content)
+            content->setLive(true);
+    }
+    m_frozenContents.clear();
+}
+
+void CaptureManagerV1::restoreFreezeExcludedItems()
+{
+    for (const auto &[item, opacity] : std::as_const(m_freezeExcludedItems)) {
+        if (item)
+            item->setOpacity(opacity);
+    }
+    m_freezeExcludedItems.clear();
+}
+
+CaptureFreezeSnapshot::CaptureFreezeSnapshot(QQuickItem *parent)
+    : QQuickPaintedItem(parent)
+{
+    setOpaquePainting(true);
+}
+
+void CaptureFreezeSnapshot::setImage(const QImage &image)
+{
+    m_image = image;
+    setVisible(!m_image.isNull());
+    update();
+}
+
+void CaptureFreezeSnapshot::paint(QPainter *painter)
+{
+    painter->drawImage(boundingRect(), m_image);
 }
 
 void CaptureManagerV1::handleContextBeforeDestroy(CaptureContextV1 *context)
@@ -581,7 +1133,9 @@ void CaptureSourceSelector::doneSelection()
             this,
             &CaptureSourceSelector::createImage);
     m_internalContentItem->setVisible(false);
-    m_canvas->surfaceItem()->setSubsurfacesVisible(false);
+    // Mask is optional, e.g. a client selecting without any UI.
+    if (m_canvas)
+        m_canvas->surfaceItem()->setSubsurfacesVisible(false);
 }
 
 void CaptureSourceSelector::cancelSelection()
@@ -744,6 +1298,66 @@ CaptureSourceSurface::CaptureSourceSurface(WSurfaceItemContent *surfaceItemConte
     : CaptureSource(surfaceItemContent, devicePixelRatio, nullptr)
     , m_surfaceItemContent(surfaceItemContent)
 {
+    createOffscreenContent();
+}
+
+CaptureSourceSurface::~CaptureSourceSurface()
+{
+    if (m_offscreenContent)
+        m_offscreenContent->deleteLater();
+}
+
+void CaptureSourceSurface::createOffscreenContent()
+{
+    auto renderWindow = qobject_cast<WOutputRenderWindow *>(m_surfaceItemContent->window());
+    if (!renderWindow || !m_surfaceItemContent->surface())
+        return;
+    // Render only this surface for capture, independent of whether the window is
+    // shown in the scene. The item must stay in the scene for its texture to be
+    // updated, so hide it the way hidden layer sources are: a culled item keeps
+    // its paint node, but the node is left out when outputs render the scene.
+    m_offscreenContent = new WSurfaceItemContent(renderWindow->contentItem());
+    m_offscreenContent->setSurface(m_surfaceItemContent->surface());
+    m_offscreenContent->setSize(m_surfaceItemContent->size());
+    m_offscreenContent->setEnabled(false);
+    QQuickItemPrivate::get(m_offscreenContent)->setCulled(true);
+    // The source lives in render thread and may be gone before the deferred delete of
+    // the copy, don't let these run on the GUI thread with a dangling this.
+    const QPointer<WSurfaceItemContent> content = m_surfaceItemContent;
+    const QPointer<WSurfaceItemContent> offscreenContent = m_offscreenContent;
+    connect(m_surfaceItemContent,
+            &QQuickItem::widthChanged,
+            m_offscreenContent,
+            [content, offscreenContent] {
+                if (content && offscreenContent)
+                    offscreenContent->setWidth(content->width());
+            });
+    connect(m_surfaceItemContent,
+            &QQuickItem::heightChanged,
+            m_offscreenContent,
+            [content, offscreenContent] {
+                if (content && offscreenContent)
+                    offscreenContent->setHeight(content->height());
+            });
+    // Hidden surface doesn't receive frame callbacks from the scene, keep the client
+    // producing new buffers at the compositor's pace.
+    connect(renderWindow, &WOutputRenderWindow::renderEnd, m_offscreenContent, [content] {
+        if (content && !content->isVisible() && content->surface())
+            content->surface()->notifyFrameDone();
+    });
+    m_sourceList.first().second = m_offscreenContent;
+}
+
+void CaptureSourceSurface::createImage()
+{
+    // The image is taken when selection ends, while the scene may still be frozen. Grab
+    // the surface item in the scene, which holds the frozen buffer, the offscreen copy
+    // always follows the client.
+    if (!m_surfaceItemContent || !m_surfaceItemContent->isVisible()) {
+        CaptureSource::createImage();
+        return;
+    }
+    grabImage(m_surfaceItemContent.data());
 }
 
 qw_buffer *CaptureSourceSurface::internalBuffer()
@@ -762,6 +1376,24 @@ qw_buffer *CaptureSourceSurface::internalBuffer()
     }
 }
 
+void CaptureSourceSurface::connectDamage()
+{
+    if (!m_surfaceItemContent || !m_surfaceItemContent->surface())
+        return;
+    auto surface = m_surfaceItemContent->surface()->handle();
+    // Source lives in render thread, read the commit state before it changes again.
+    connect(
+        surface,
+        &qw_surface::notify_commit,
+        this,
+        [this, surface] {
+            const QRegion damage = regionFromPixman(&surface->handle()->buffer_damage);
+            if (!damage.isEmpty())
+                Q_EMIT damaged(damage);
+        },
+        Qt::DirectConnection);
+}
+
 CaptureSource::CaptureSourceType CaptureSourceSurface::sourceType()
 {
     return CaptureSource::Surface;
@@ -821,6 +1453,56 @@ void CaptureSourceSelector::componentComplete()
             Workspace::ShowOnAllWorkspaceId); // TODO: use a more reasonable id
     }
     QQuickItem::componentComplete();
+    // Select without user interaction, used to drive capture on headless sessions.
+    if (qEnvironmentVariableIsSet("TREELAND_CAPTURE_AUTO_SELECT")) {
+        QMetaObject::invokeMethod(this,
+                                  &CaptureSourceSelector::autoSelectSource,
+                                  Qt::QueuedConnection);
+    }
+}
+
+void CaptureSourceSelector::autoSelectSource()
+{
+    const auto outputItems = m_itemSelector->outputItems();
+    if (outputItems.isEmpty()) {
+        qCWarning(qLcCapture()) << "No output to auto select capture source from.";
+        return;
+    }
+    auto outputItem = outputItems.first();
+    auto viewport = outputItem->property("screenViewport").value<WOutputViewport *>();
+    if (!viewport)
+        return;
+    const QRectF outputRect = mapRectFromItem(outputItem, outputItem->boundingRect());
+    switch (selectionMode()) {
+    case SelectionMode::SelectRegion: {
+        // Center half of the first output.
+        const QSizeF size = outputRect.size() / 2;
+        const QRectF region(outputRect.center() - QPointF(size.width(), size.height()) / 2, size);
+        setSelectedSource(
+            new CaptureSourceRegion(viewport, mapRectToItem(viewport, region).toRect()),
+            region.toRect());
+        setItemSelectionMode(false);
+        break;
+    }
+    case SelectionMode::SelectWindow: {
+        // Topmost surface in paint order.
+        const auto items = m_itemSelector->selectableItems();
+        for (auto it = items.crbegin(); it != items.crend(); ++it) {
+            if (auto surfaceItemContent = qobject_cast<WSurfaceItemContent *>(*it)) {
+                setSelectedSource(
+                    new CaptureSourceSurface(surfaceItemContent, outputItem->devicePixelRatio()),
+                    mapRectFromItem(surfaceItemContent, surfaceItemContent->boundingRect())
+                        .toRect());
+                return;
+            }
+        }
+        qCWarning(qLcCapture()) << "No window to auto select capture source from.";
+        break;
+    }
+    case SelectionMode::SelectOutput:
+        setSelectedSource(new CaptureSourceOutput(viewport), outputRect.toRect());
+        break;
+    }
 }
 
 void CaptureSourceSelector::mousePressEvent(QMouseEvent *event)
@@ -835,13 +1517,24 @@ void CaptureSourceSelector::mouseReleaseEvent(QMouseEvent *event)
 {
     switch (selectionMode()) {
     case SelectionMode::SelectRegion: {
-        auto viewport =
-            m_itemSelector->outputItem()->property("screenViewport").value<WOutputViewport *>();
-        if (viewport) {
-            setSelectedSource(
-                new CaptureSourceRegion(viewport,
-                                        mapRectToItem(viewport, selectionRegion()).toRect()),
-                selectionRegion().toRect());
+        // Collect the part of selection on every output it spans.
+        CaptureSourceRegion *regionSource = nullptr;
+        const auto outputItems = m_itemSelector->outputItems();
+        for (auto outputItem : outputItems) {
+            auto viewport = outputItem->property("screenViewport").value<WOutputViewport *>();
+            if (!viewport)
+                continue;
+            const QRect region = mapRectToItem(viewport, selectionRegion()).toRect()
+                & viewport->boundingRect().toRect();
+            if (region.isEmpty())
+                continue;
+            if (!regionSource)
+                regionSource = new CaptureSourceRegion(viewport, region);
+            else
+                regionSource->addViewportRegion(viewport, region);
+        }
+        if (regionSource) {
+            setSelectedSource(regionSource, selectionRegion().toRect());
         }
         // Exit item selection mode after first click
         setItemSelectionMode(false);
@@ -899,20 +1592,32 @@ QImage CaptureSource::image() const
 void CaptureSource::createImage()
 {
     if (m_sourceList.size() == 1 && m_sourceList.first().first) {
-        auto grabber = new WTextureCapturer(m_sourceList.first().second, this);
-        grabber->grabToImage()
-            .then([this](QImage image) {
-                m_image = std::move(image);
-                Q_EMIT imageReady();
-            })
-            .onFailed([](const std::exception &e) {
-                qCCritical(qLcCapture) << e.what();
-            });
+        grabImage(m_sourceList.first().second);
     } else {
-        // TODO: support multiple sources
+        qCWarning(qLcCapture()) << "Source" << *this << "has no single target to grab.";
     }
 }
 
+void CaptureSource::grabImage(WTextureProviderProvider *target)
+{
+    auto grabber = new WTextureCapturer(target, this);
+    grabber->grabToImage()
+        .then([this](QImage image) {
+            m_image = std::move(image);
+            Q_EMIT imageReady();
+        })
+        .onFailed([](const std::exception &e) {
+            qCCritical(qLcCapture) << e.what();
+        });
+}
+
+QPointF CaptureSource::mapFromScene(const QPointF &scenePosition) const
+{
+    if (m_sourceList.isEmpty() || !m_sourceList.first().first)
+        return {};
+    return m_sourceList.first().first->mapFromScene(scenePosition) * m_devicePixelRatio;
+}
+
 qw_buffer *CaptureSource::sourceDMABuffer()
 {
     auto buffer = internalBuffer();
@@ -922,22 +1627,55 @@ qw_buffer *CaptureSource::sourceDMABuffer()
     return buffer;
 }
 
+void CaptureSource::startDamageTracking()
+{
+    if (m_damageTracking)
+        return;
+    m_damageTracking = true;
+    connectDamage();
+}
+
 void CaptureSource::copyBuffer(qw_buffer *buffer)
 {
     Q_ASSERT(imageValid());
-    auto width = cropRect().width();
-    auto height = cropRect().height();
+    const QImage &source = m_image;
+    const QRect crop = cropRect() & source.rect();
     uint32_t format;
     size_t stride;
     void *data;
-    buffer->begin_data_ptr_access(WLR_BUFFER_DATA_PTR_ACCESS_WRITE, &data, &format, &stride);
-    Q_ASSERT(stride == width * 4); // For QImage
-    QImage img = image().copy(cropRect());
+    if (!buffer->begin_data_ptr_access(WLR_BUFFER_DATA_PTR_ACCESS_WRITE, &data, &format, &stride)) {
+        qCWarning(qLcCapture()) << "Cannot access data of client buffer" << buffer;
+        return;
+    }
+    const int width = qMin(crop.width(), buffer->handle()->width);
+    const int height = qMin(crop.height(), buffer->handle()->height);
+    Q_ASSERT(stride >= size_t(width) * 4);
     auto bufFormat = WTools::toImageFormat(format);
-    if (image().format() != bufFormat) {
-        img = image().convertToFormat(bufFormat);
+    const auto srcLayout = pixelLayout(source.format());
+    const auto dstLayout = pixelLayout(bufFormat);
+    auto dst = static_cast<uchar *>(data);
+    if (srcLayout.order != PixelLayout::Unknown && dstLayout.order != PixelLayout::Unknown
+        && (srcLayout.opaque || dstLayout.opaque
+            || srcLayout.premultiplied == dstLayout.premultiplied)) {
+        // Fast path, only read the cropped rows and write them to client buffer directly.
+        const bool swapRB = srcLayout.order != dstLayout.order;
+        for (int y = 0; y < height; ++y) {
+            auto srcLine = reinterpret_cast<const uint32_t *>(source.constScanLine(crop.y() + y))
+                + crop.x();
+            swizzleRow(srcLine,
+                       reinterpret_cast<uint32_t *>(dst + y * stride),
+                       width,
+                       swapRB,
+                       dstLayout.opaque);
+        }
+    } else {
+        // Let QImage handle the rest formats, but only for the cropped area.
+        const QImage img = source.copy(crop).convertToFormat(bufFormat);
+        const size_t lineSize = qMin<size_t>(img.bytesPerLine(), stride);
+        for (int y = 0; y < height; ++y) {
+            memcpy(dst + y * stride, img.constScanLine(y), lineSize);
+        }
     }
-    memcpy(data, img.constBits(), stride * height);
     buffer->end_data_ptr_access();
 }
 
@@ -956,6 +1694,23 @@ qw_buffer *CaptureSourceOutput::internalBuffer()
         return nullptr;
 }
 
+void CaptureSourceOutput::connectDamage()
+{
+    if (!m_outputViewport || !m_outputViewport->output())
+        return;
+    // Source lives in render thread, the commit event is only valid during emission.
+    connect(
+        m_outputViewport->output()->handle(),
+        &qw_output::notify_commit,
+        this,
+        [this](wlr_output_event_commit *event) {
+            const QRegion damage = outputCommitDamage(event);
+            if (!damage.isEmpty())
+                Q_EMIT damaged(damage);
+        },
+        Qt::DirectConnection);
+}
+
 QRect CaptureSourceOutput::cropRect() const
 {
     return m_outputViewport
@@ -990,6 +1745,27 @@ qw_buffer *CaptureSourceRegion::internalBuffer()
     }
 }
 
+void CaptureSourceRegion::connectDamage()
+{
+    // Session of region is only backed by a single viewport, see internalBuffer.
+    if (m_viewportRegions.size() != 1)
+        return;
+    auto viewport = m_viewportRegions.first().first;
+    if (!viewport || !viewport->output())
+        return;
+    // Source lives in render thread, the commit event is only valid during emission.
+    connect(
+        viewport->output()->handle(),
+        &qw_output::notify_commit,
+        this,
+        [this](wlr_output_event_commit *event) {
+            const QRegion damage = outputCommitDamage(event) & cropRect();
+            if (!damage.isEmpty())
+                Q_EMIT damaged(damage);
+        },
+        Qt::DirectConnection);
+}
+
 CaptureSource::CaptureSourceType CaptureSourceRegion::sourceType()
 {
     return CaptureSource::Region;
@@ -997,43 +1773,28 @@ CaptureSource::CaptureSourceType CaptureSourceRegion::sourceType()
 
 QRect CaptureSourceRegion::cropRect() const
 {
+    if (m_viewportRegions.size() > 1) {
+        // Stitched image contains exactly the selected region.
+        return { QPoint(0, 0), (sceneRegion().size() * stitchDevicePixelRatio()).toSize() };
+    }
     QRect result{};
-    WOutputViewport *ref = nullptr;
     for (const auto &[viewport, region] : std::as_const(m_viewportRegions)) {
-        if (!viewport)
-            continue;
-        if (!ref) {
+        if (viewport)
             result = scaledRect(region, viewport->devicePixelRatio()).toRect();
-            ref = viewport;
-        } else {
-            auto mapped =
-                scaledRect(ref->mapRectFromItem(viewport, region), viewport->devicePixelRatio())
-                    .toRect(); // FIXME: firstly map or firstly scale?
-            result = result.united(mapped);
-        }
     }
     return result;
 }
 
 QSize CaptureSourceRegion::sourceSize() const
 {
-    QRect result{};
-    WOutputViewport *ref = nullptr;
+    if (m_viewportRegions.size() > 1)
+        return cropRect().size();
+    QSize result{};
     for (const auto &[viewport, region] : std::as_const(m_viewportRegions)) {
-        if (!viewport)
-            continue;
-        if (!ref) {
-            result = scaledRect(viewport->boundingRect(), viewport->devicePixelRatio()).toRect();
-            ref = viewport;
-        } else {
-            auto mapped = ref->mapRectFromItem(
-                                 viewport,
-                                 scaledRect(viewport->boundingRect(), viewport->devicePixelRatio()))
-                              .toRect(); // FIXME: firstly map or firstly scale?
-            result = result.united(mapped);
-        }
+        if (viewport)
+            result = (viewport->size() * viewport->devicePixelRatio()).toSize();
     }
-    return result.size();
+    return result;
 }
 
 bool CaptureSourceRegion::addViewportRegion(WOutputViewport *viewport, const QRect &region)
@@ -1048,9 +1809,74 @@ bool CaptureSourceRegion::addViewportRegion(WOutputViewport *viewport, const QRe
         }
     }
     m_viewportRegions.insert(insertIndex, { viewport, region });
+    addTarget(viewport);
     return true;
 }
 
+QRectF CaptureSourceRegion::sceneRegion() const
+{
+    QRectF result{};
+    for (const auto &[viewport, region] : std::as_const(m_viewportRegions)) {
+        if (viewport)
+            result = result.united(viewport->mapRectToScene(QRectF(region)));
+    }
+    return result;
+}
+
+qreal CaptureSourceRegion::stitchDevicePixelRatio() const
+{
+    // Use the highest ratio so that no output loses detail.
+    qreal ratio = 0;
+    for (const auto &[viewport, _] : std::as_const(m_viewportRegions)) {
+        if (viewport)
+            ratio = qMax(ratio, viewport->devicePixelRatio());
+    }
+    return ratio > 0 ? ratio : m_devicePixelRatio;
+}
+
+void CaptureSourceRegion::createImage()
+{
+    if (m_viewportRegions.size() <= 1) {
+        CaptureSource::createImage();
+        return;
+    }
+    const QPointF origin = sceneRegion().topLeft();
+    const qreal ratio = stitchDevicePixelRatio();
+    QList<QFuture<QImage>> grabs;
+    // Source rect in the image of viewport and target rect in the stitched image.
+    QList<QPair<QRect, QRectF>> placements;
+    for (const auto &[viewport, region] : std::as_const(m_viewportRegions)) {
+        if (!viewport)
+            continue;
+        auto grabber =
+            new WTextureCapturer(static_cast<WTextureProviderProvider *>(viewport.data()), this);
+        grabs.append(grabber->grabToImage());
+        placements.append(
+            { scaledRect(region, viewport->devicePixelRatio()).toRect(),
+              scaledRect(viewport->mapRectToScene(QRectF(region)).translated(-origin), ratio) });
+    }
+    QtFuture::whenAll(grabs.begin(), grabs.end())
+        .then(this,
+              [this, placements, size = cropRect().size()](const QList<QFuture<QImage>> &results) {
+                  QImage stitched(size, QImage::Format_ARGB32_Premultiplied);
+                  stitched.fill(Qt::transparent);
+                  QPainter painter(&stitched);
+                  painter.setCompositionMode(QPainter::CompositionMode_Source);
+                  painter.setRenderHint(QPainter::SmoothPixmapTransform);
+                  for (qsizetype i = 0; i < results.size(); ++i) {
+                      painter.drawImage(placements[i].second,
+                                        results[i].result(),
+                                        placements[i].first);
+                  }
+                  painter.end();
+                  m_image = std::move(stitched);
+                  Q_EMIT imageReady();
+              })
+        .onFailed([](const std::exception &e) {
+            qCCritical(qLcCapture) << e.what();
+        });
+}
+
 void CaptureSourceSelector::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
 {
     if (m_captureManager->maskShellSurface()) {
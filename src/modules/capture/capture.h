@@ -20,12 +20,19 @@
 #include <QPointer>
 #include <QQuickPaintedItem>
 #include <QRect>
+#include <QRegion>
+#include <QTimer>
+
+#include <chrono>
 
 extern "C" {
+#include <wlr/render/swapchain.h>
 #include <wlr/types/wlr_buffer.h>
 }
 
 WAYLIB_SERVER_BEGIN_NAMESPACE
+class WCursor;
+class WOutputItem;
 class WOutputRenderWindow;
 class WOutputViewport;
 class WToplevelSurface;
@@ -79,6 +86,8 @@ Q_SIGNALS:
     void bufferDestroyed();
     void targetDestroyed();
     void targetResized();
+    // Damage of the source buffer in buffer local coordinates.
+    void damaged(const QRegion &region);
 
 public:
     bool imageValid() const;
@@ -86,7 +95,7 @@ public:
     // Get an image that is already cropped.
     QImage image() const;
 
-    void createImage();
+    virtual void createImage();
 
     /**
      * @brief DMA buffer of source, there are three cases
@@ -104,6 +113,15 @@ public:
      */
     void copyBuffer(qw_buffer *buffer);
 
+    /**
+     * @brief startDamageTracking begin to emit damaged when the content of
+     * sourceDMABuffer changes, it's safe to call it more than once
+     */
+    void startDamageTracking();
+
+    // Map a scene position to the buffer coordinates of sourceDMABuffer.
+    QPointF mapFromScene(const QPointF &scenePosition) const;
+
     // Cropped area of source
     virtual QRect cropRect() const = 0;
 
@@ -114,6 +132,9 @@ public:
 
 protected:
     virtual qw_buffer *internalBuffer() = 0;
+    virtual void connectDamage() = 0;
+    // Grab target into m_image, imageReady is emitted when done.
+    void grabImage(WTextureProviderProvider *target);
 
     template<IsCaptureSourceTarget T>
     void addTarget(T *target)
@@ -137,6 +158,7 @@ protected:
     friend QDebug operator<<(QDebug debug, CaptureSource &captureSource);
     QImage m_image;
     QMetaObject::Connection m_bufferConn;
+    bool m_damageTracking{ false };
     QList<QPair<QPointer<QQuickItem>, WTextureProviderProvider *>> m_sourceList;
     qreal m_devicePixelRatio;
 };
@@ -146,6 +168,36 @@ Q_DECLARE_INTERFACE(CaptureSource, CaptureSource_iid)
 
 class CaptureContextV1;
 
+// Follows the cursor items of a render window in GUI thread, reports position in
+// scene coordinates and the cursor image when its shape changes.
+class CaptureCursorTracker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CaptureCursorTracker(WOutputRenderWindow *renderWindow);
+    // Report current position and image regardless of changes.
+    void refresh();
+
+Q_SIGNALS:
+    void positionChanged(const QPointF &scenePosition);
+    void imageChanged(const QImage &image, const QPointF &hotSpot);
+
+private:
+    void updateCursorItems();
+    void updateCursorSurface();
+    void updatePosition();
+    void updateImage();
+    QQuickItem *activeCursor() const;
+
+    const QPointer<WOutputRenderWindow> m_renderWindow;
+    QList<QPointer<QQuickItem>> m_cursorItems;
+    // Shared by the cursor items of all outputs, reports shape changes.
+    QPointer<WCursor> m_cursor;
+    QMetaObject::Connection m_cursorSurfaceCommit;
+    QImage m_lastImage;
+    QPointF m_lastHotSpot;
+};
+
 class CaptureContextModel : public QAbstractListModel
 {
     Q_OBJECT
@@ -188,14 +240,23 @@ public:
         };
     };
 
+    // One slot of the frame ring, a slot is free again once client acks its frame.
     struct FrameData
     {
         FrameTime readyAt{};
         wlr_dmabuf_attributes attribs{};
+        // Locked while in flight, so the output won't render into it again.
+        QW_NAMESPACE::qw_buffer *buffer{ nullptr };
         bool acked{ false };
         bool canceled{ false };
     };
 
+    // Every slot in flight pins an output swapchain buffer, or a buffer of the client for
+    // surface sources. Leave the output its front buffer and one to render into, so a
+    // slow client makes frames drop instead of stalling output rendering.
+    static constexpr uint MaxFrameRingSize = WLR_SWAPCHAIN_CAP - 2;
+    static constexpr uint DefaultFrameRingSize = MaxFrameRingSize;
+
     CaptureSource *source() const;
     void setSource(CaptureSource *source, const QRect &captureRegion);
 
@@ -218,9 +279,19 @@ public:
     };
     Q_ENUM(SourceFailure)
 
+    enum CursorMode
+    {
+        CursorHidden = 0,
+        CursorEmbedded,
+        CursorMetadata,
+    };
+    Q_ENUM(CursorMode)
+    CursorMode cursorMode() const;
+
     CaptureContextV1(treeland_capture_context_v1 *h,
                      WOutputRenderWindow *outputRenderWindow,
                      QObject *parent = nullptr);
+    ~CaptureContextV1() override;
     void sendSourceFailed(SourceFailure failure);
 
     inline QRect captureRegion() const
@@ -228,6 +299,15 @@ public:
         return m_captureRegion;
     }
 
+    uint frameRingSize() const;
+    // Takes effect when the next session starts, clamped to [1, MaxFrameRingSize].
+    void setFrameRingSize(uint size);
+    quint64 droppedFrames() const;
+
+    uint maxFrameRate() const;
+    // Renders in between are coalesced into one frame, 0 means no limit.
+    void setMaxFrameRate(uint fps);
+
 Q_SIGNALS:
     void sourceChanged();
     void finishSelect();
@@ -241,6 +321,12 @@ private:
     void handleSessionStart();
     void handleFrameDone(uint32_t tvSecHi, uint32_t tvSecLo, uint32_t tvUsec);
     void handleRenderEnd();
+    void handleSourceDamaged(const QRegion &region);
+    void trySendFrame();
+    void releaseFrame(FrameData &frame);
+    void releaseFrameRing();
+    void handleCursorPosition(const QPointF &scenePosition);
+    void handleCursorImage(const QImage &image, const QPointF &hotSpot);
 
     void ensureSourceSessionConnection();
     void handleSourceDestroyed();
@@ -250,11 +336,37 @@ private:
     QPointer<treeland_capture_frame_v1> m_frame{ nullptr };
     QPointer<treeland_capture_session_v1> m_session{ nullptr };
     const QPointer<WOutputRenderWindow> m_outputRenderWindow;
-    FrameData m_currentFrameData{};
+    QList<FrameData> m_frameRing;
+    uint m_frameRingSize{ DefaultFrameRingSize };
+    FrameTime m_lastReadyAt{};
+    // Time of the latest render that changed the source
+    FrameTime m_renderedAt{};
+    quint64 m_droppedFrames{ 0 };
+    uint m_maxFrameRate{ 0 };
+    std::chrono::steady_clock::time_point m_nextFrameDeadline{};
+    QTimer *m_frameTimer{ nullptr };
+    QPointer<CaptureCursorTracker> m_cursorTracker;
+    QPoint m_lastCursorPosition{ -1, -1 };
     QRect m_captureRegion;
+    // Damage accumulated since the last frame sent to session
+    QRegion m_pendingDamage;
+    bool m_fullDamage{ true };
 };
 class CaptureSourceSelector;
 
+// Still image of an output, shown in place of the live scene while selection freezes it.
+class CaptureFreezeSnapshot : public QQuickPaintedItem
+{
+    Q_OBJECT
+public:
+    explicit CaptureFreezeSnapshot(QQuickItem *parent = nullptr);
+    void setImage(const QImage &image);
+    void paint(QPainter *painter) override;
+
+private:
+    QImage m_image;
+};
+
 class CaptureManagerV1
     : public QObject
     , public WServerInterface
@@ -284,6 +396,8 @@ public:
 
     WOutputRenderWindow *outputRenderWindow() const;
     void setOutputRenderWindow(WOutputRenderWindow *renderWindow);
+    uint frameRingSize() const;
+    void setFrameRingSize(uint size);
     QByteArrayView interfaceName() const override;
     QPointer<WToplevelSurface> maskShellSurface() const;
     QPointer<SurfaceWrapper> maskSurfaceWrapper() const;
@@ -304,14 +418,28 @@ private Q_SLOTS:
     void handleContextBeforeDestroy(CaptureContextV1 *context);
 
 private:
+    void takeFreezeSnapshots(const QList<WOutputItem *> &outputItems,
+                             const QList<QQuickItem *> &excludedItems);
+    void attachFreezeSnapshots();
+    void releaseFreezeSnapshots();
+    void restoreFreezeExcludedItems();
+
     treeland_capture_manager_v1 *m_manager;
     CaptureContextModel *m_captureContextModel;
     CaptureContextV1 *m_contextInSelection;
     WOutputRenderWindow *m_outputRenderWindow;
+    uint m_frameRingSize{ CaptureContextV1::DefaultFrameRingSize };
     QPointF m_frozenCursorPos;
     QPointer<WToplevelSurface> m_maskShellSurface;
     QPointer<SurfaceWrapper> m_maskSurfaceWrapper;
     CaptureSourceSelector *m_selector;
+    QList<QPair<QPointer<WOutputItem>, QPointer<CaptureFreezeSnapshot>>> m_freezeSnapshots;
+    // Items hidden while snapshots are grabbed, with their original opacity.
+    QList<QPair<QPointer<QQuickItem>, qreal>> m_freezeExcludedItems;
+    // Bumped on every freeze and release, grabs of an earlier freeze are ignored.
+    quint64 m_freezeSerial{ 0 };
+    // Surface contents kept on their frozen buffer while windows can be selected.
+    QList<QPointer<WSurfaceItemContent>> m_frozenContents;
 };
 
 class CaptureSourceSurface : public CaptureSource
@@ -319,13 +447,21 @@ class CaptureSourceSurface : public CaptureSource
     Q_OBJECT
 public:
     explicit CaptureSourceSurface(WSurfaceItemContent *surfaceItemContent, qreal devicePixelRatio);
+    ~CaptureSourceSurface() override;
     qw_buffer *internalBuffer() override;
+    void connectDamage() override;
     CaptureSourceType sourceType() override;
     QRect cropRect() const override;
     QSize sourceSize() const override;
+    void createImage() override;
 
 private:
+    void createOffscreenContent();
+
     const QPointer<WSurfaceItemContent> m_surfaceItemContent;
+    // Culled copy of the surface content, keeps the texture up to date while the
+    // window is minimized, on another workspace or covered.
+    QPointer<WSurfaceItemContent> m_offscreenContent;
 };
 
 class CaptureSourceOutput : public CaptureSource
@@ -334,6 +470,7 @@ class CaptureSourceOutput : public CaptureSource
 public:
     explicit CaptureSourceOutput(WOutputViewport *viewport);
     qw_buffer *internalBuffer() override;
+    void connectDamage() override;
     CaptureSourceType sourceType() override;
     QRect cropRect() const override;
     QSize sourceSize() const override;
@@ -348,12 +485,18 @@ class CaptureSourceRegion : public CaptureSource
 public:
     CaptureSourceRegion(WOutputViewport *viewport, const QRect &region);
     qw_buffer *internalBuffer() override;
+    void connectDamage() override;
     CaptureSourceType sourceType() override;
     QRect cropRect() const override;
     QSize sourceSize() const override;
     bool addViewportRegion(WOutputViewport *viewport, const QRect &region);
+    // Grab all viewports in parallel and stitch them when region spans outputs.
+    void createImage() override;
 
 private:
+    QRectF sceneRegion() const;
+    qreal stitchDevicePixelRatio() const;
+
     QList<QPair<QPointer<WOutputViewport>, QRect>> m_viewportRegions;
 };
 class ToolBarModel;
@@ -429,6 +572,7 @@ private:
 
     void updateItemSelectorItemTypes();
     void updateCursorShape();
+    void autoSelectSource();
 
     QPointer<QQuickItem> m_internalContentItem{};
     QPointer<ItemSelector> m_itemSelector{};
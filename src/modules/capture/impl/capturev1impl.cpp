@@ -8,6 +8,10 @@
 
 #include <QDebug>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
 extern "C" {
 #define static
 #include "wlr/types/wlr_compositor.h"
@@ -40,6 +44,17 @@ static const struct treeland_capture_frame_v1_interface frame_impl = {
     .copy = handle_treeland_capture_frame_v1_copy
 };
 
+static const struct treeland_capture_session_extension_manager_v1_interface
+    extension_manager_impl = {
+        .destroy = handle_treeland_capture_session_extension_manager_v1_destroy,
+        .get_extension = handle_treeland_capture_session_extension_manager_v1_get_extension
+    };
+
+static const struct treeland_capture_session_extension_v1_interface extension_impl = {
+    .destroy = handle_treeland_capture_session_extension_v1_destroy,
+    .set_max_frame_rate = handle_treeland_capture_session_extension_v1_set_max_frame_rate
+};
+
 void handle_treeland_capture_context_v1_destroy([[maybe_unused]] wl_client *client,
                                                 wl_resource *resource)
 {
@@ -81,6 +96,14 @@ treeland_capture_frame_v1 *capture_frame_from_resource(wl_resource *resource)
     return static_cast<treeland_capture_frame_v1 *>(wl_resource_get_user_data(resource));
 }
 
+treeland_capture_session_v1 *capture_session_from_extension_resource(wl_resource *resource)
+{
+    Q_ASSERT(wl_resource_instance_of(resource,
+                                     &treeland_capture_session_extension_v1_interface,
+                                     &extension_impl));
+    return static_cast<treeland_capture_session_v1 *>(wl_resource_get_user_data(resource));
+}
+
 void capture_session_resource_destroy(struct wl_resource *resource)
 {
     auto session = capture_session_from_resource(resource);
@@ -88,6 +111,9 @@ void capture_session_resource_destroy(struct wl_resource *resource)
         return;
     }
     Q_EMIT session->beforeDestroy();
+    // Extension outlives the session as an inert object.
+    if (session->extension)
+        wl_resource_set_user_data(session->extension, nullptr);
     delete session;
 }
 
@@ -101,6 +127,15 @@ void capture_context_resource_destroy(struct wl_resource *resource)
     delete context;
 }
 
+void capture_session_extension_resource_destroy(struct wl_resource *resource)
+{
+    auto session = capture_session_from_extension_resource(resource);
+    if (!session) {
+        return;
+    }
+    session->extension = nullptr;
+}
+
 void capture_frame_resource_destroy(struct wl_resource *resource)
 {
     struct treeland_capture_frame_v1 *frame = capture_frame_from_resource(resource);
@@ -125,6 +160,23 @@ void treeland_capture_manager_bind(wl_client *client, void *data, uint32_t versi
     wl_resource_set_implementation(resource, &manager_impl, manager, nullptr);
 }
 
+void treeland_capture_session_extension_manager_bind(wl_client *client,
+                                                     void *data,
+                                                     uint32_t version,
+                                                     uint32_t id)
+{
+    wl_resource *resource =
+        wl_resource_create(client,
+                           &treeland_capture_session_extension_manager_v1_interface,
+                           version,
+                           id);
+    if (!resource) {
+        wl_client_post_no_memory(client);
+        return;
+    }
+    wl_resource_set_implementation(resource, &extension_manager_impl, data, nullptr);
+}
+
 treeland_capture_manager_v1::treeland_capture_manager_v1(wl_display *display, QObject *parent)
     : QObject(parent)
     , global(wl_global_create(display,
@@ -132,6 +184,11 @@ treeland_capture_manager_v1::treeland_capture_manager_v1(wl_display *display, QO
                               1,
                               this,
                               treeland_capture_manager_bind))
+    , extensionGlobal(wl_global_create(display,
+                                       &treeland_capture_session_extension_manager_v1_interface,
+                                       1,
+                                       this,
+                                       treeland_capture_session_extension_manager_bind))
 {
 }
 
@@ -167,6 +224,48 @@ void handle_treeland_capture_session_v1_start([[maybe_unused]] wl_client *client
     Q_EMIT session->start();
 }
 
+void handle_treeland_capture_session_extension_manager_v1_destroy(
+    [[maybe_unused]] wl_client *client,
+    wl_resource *resource)
+{
+    wl_resource_destroy(resource);
+}
+
+void handle_treeland_capture_session_extension_manager_v1_get_extension(wl_client *client,
+                                                                        wl_resource *resource,
+                                                                        uint32_t id,
+                                                                        wl_resource *session)
+{
+    auto capture_session = capture_session_from_resource(session);
+    Q_ASSERT(capture_session);
+    if (capture_session->extension) {
+        wl_resource_post_error(resource,
+                               TREELAND_CAPTURE_SESSION_EXTENSION_MANAGER_V1_ERROR_ALREADY_EXTENDED,
+                               "Capture session already has an extension object");
+        return;
+    }
+    wl_resource *extension_resource =
+        wl_resource_create(client,
+                           &treeland_capture_session_extension_v1_interface,
+                           wl_resource_get_version(resource),
+                           id);
+    if (!extension_resource) {
+        wl_client_post_no_memory(client);
+        return;
+    }
+    wl_resource_set_implementation(extension_resource,
+                                   &extension_impl,
+                                   capture_session,
+                                   capture_session_extension_resource_destroy);
+    capture_session->extension = extension_resource;
+}
+
+void handle_treeland_capture_session_extension_v1_destroy([[maybe_unused]] wl_client *client,
+                                                          wl_resource *resource)
+{
+    wl_resource_destroy(resource);
+}
+
 void handle_treeland_capture_manager_v1_get_context(wl_client *client,
                                                     wl_resource *resource,
                                                     uint32_t context)
@@ -236,7 +335,7 @@ void handle_treeland_capture_context_v1_select_source(wl_client *client,
         context->sourceHint = 0x7; // Contains all source type
     }
     context->freeze = freeze;
-    context->withCursor = with_cursor;
+    context->cursorMode = with_cursor;
     if (mask) {
         context->mask = WSurface::fromHandle(wlr_surface_from_resource(mask));
         Q_ASSERT(context->mask);
@@ -345,6 +444,60 @@ void treeland_capture_session_v1::sendSourceResizeCancel()
                                             TREELAND_CAPTURE_SESSION_V1_CANCEL_REASON_RESIZING);
 }
 
+void treeland_capture_session_v1::sendDamage(const QRect &rect)
+{
+    if (!extension)
+        return;
+    treeland_capture_session_extension_v1_send_damage(extension,
+                                                      rect.x(),
+                                                      rect.y(),
+                                                      rect.width(),
+                                                      rect.height());
+}
+
+bool treeland_capture_session_v1::canSendCursor() const
+{
+    return extension;
+}
+
+void treeland_capture_session_v1::sendCursorPosition(const QPoint &position)
+{
+    if (!extension)
+        return;
+    treeland_capture_session_extension_v1_send_cursor_position(extension,
+                                                               position.x(),
+                                                               position.y());
+}
+
+void treeland_capture_session_v1::sendCursorImage(const QImage &image, const QPoint &hotSpot)
+{
+    if (!extension)
+        return;
+    // Same as wl_keyboard keymap, pass pixels through a sealed memfd.
+    const QImage cursor = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    const size_t size = cursor.sizeInBytes();
+    int fd = memfd_create("treeland-capture-cursor", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) {
+        qCWarning(qLcCapture) << "Failed to create memfd for capture cursor image";
+        return;
+    }
+    if (write(fd, cursor.constBits(), size) != static_cast<ssize_t>(size)) {
+        qCWarning(qLcCapture) << "Failed to write capture cursor image";
+        close(fd);
+        return;
+    }
+    fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+    treeland_capture_session_extension_v1_send_cursor_image(extension,
+                                                            fd,
+                                                            WL_SHM_FORMAT_ARGB8888,
+                                                            cursor.width(),
+                                                            cursor.height(),
+                                                            cursor.bytesPerLine(),
+                                                            hotSpot.x(),
+                                                            hotSpot.y());
+    close(fd);
+}
+
 void treeland_capture_frame_v1::setResource(wl_client *client, wl_resource *resource)
 {
     WClient *wClient = WClient::get(client);
@@ -387,3 +540,14 @@ void handle_treeland_capture_session_v1_frame_done(wl_client *,
     Q_ASSERT(session);
     Q_EMIT session->frameDone(tv_sec_hi, tv_sec_lo, tv_usec);
 }
+
+void handle_treeland_capture_session_extension_v1_set_max_frame_rate(wl_client *,
+                                                                     wl_resource *resource,
+                                                                     uint32_t fps)
+{
+    auto session = capture_session_from_extension_resource(resource);
+    // Inert once the session is gone.
+    if (!session)
+        return;
+    Q_EMIT session->maxFrameRateRequested(fps);
+}
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "treeland-capture-session-extension-unstable-v1-protocol.h"
 #include "treeland-capture-unstable-v1-protocol.h"
 
 #include <wglobal.h>
@@ -11,8 +12,12 @@
 
 #include <qwbuffer.h>
 
+#include <QImage>
+#include <QLoggingCategory>
 #include <QObject>
 
+Q_DECLARE_LOGGING_CATEGORY(qLcCapture)
+
 Q_MOC_INCLUDE(<wsurface.h>)
 WAYLIB_SERVER_BEGIN_NAMESPACE
 class WSurface;
@@ -40,7 +45,8 @@ struct treeland_capture_context_v1 : public QObject
     Q_OBJECT
 public:
     struct wl_resource *resource{ nullptr };
-    bool withCursor{ false };
+    // 0: no cursor, 1: cursor rendered into frame, 2: cursor sent as session events
+    uint32_t cursorMode{ 0 };
     bool freeze{ false };
     uint32_t sourceHint{ 0 };
     WWrapPointer<WAYLIB_SERVER_NAMESPACE::WSurface> mask{ nullptr };
@@ -94,18 +100,40 @@ struct treeland_capture_session_v1 : public QObject
     Q_OBJECT
 public:
     wl_resource *resource{ nullptr };
+    // treeland_capture_session_extension_v1 of this session, if the client created one.
+    wl_resource *extension{ nullptr };
 
     void setResource(wl_client *client, wl_resource *resource);
     void sendProduceMoreCancel();
     void sendSourceDestroyCancel();
     void sendSourceResizeCancel();
+    void sendDamage(const QRect &rect);
+    // Cursor metadata is carried by the extension, see cursor_position.
+    bool canSendCursor() const;
+    void sendCursorPosition(const QPoint &position);
+    void sendCursorImage(const QImage &image, const QPoint &hotSpot);
 
 Q_SIGNALS:
     void beforeDestroy();
     void start();
     void frameDone(uint32_t tvSecHi, uint32_t tvSecLo, uint32_t tvUsec);
+    // 0 means no limit
+    void maxFrameRateRequested(uint32_t fps);
 };
 
+void handle_treeland_capture_session_extension_manager_v1_destroy(
+    [[maybe_unused]] wl_client *client,
+    wl_resource *resource);
+void handle_treeland_capture_session_extension_manager_v1_get_extension(wl_client *client,
+                                                                        wl_resource *resource,
+                                                                        uint32_t id,
+                                                                        wl_resource *session);
+void handle_treeland_capture_session_extension_v1_destroy([[maybe_unused]] wl_client *client,
+                                                          wl_resource *resource);
+void handle_treeland_capture_session_extension_v1_set_max_frame_rate(wl_client *client,
+                                                                     wl_resource *resource,
+                                                                     uint32_t fps);
+
 void handle_treeland_capture_manager_v1_destroy([[maybe_unused]] wl_client *client,
                                                 wl_resource *resource);
 void handle_treeland_capture_manager_v1_get_context(wl_client *client,
@@ -117,6 +145,8 @@ struct treeland_capture_manager_v1 : public QObject
     Q_OBJECT
 public:
     wl_global *global;
+    // treeland_capture_session_extension_manager_v1, advertised along with the manager.
+    wl_global *extensionGlobal;
     QList<QPair<WAYLIB_SERVER_NAMESPACE::WClient *, wl_resource *>> clientResources;
     explicit treeland_capture_manager_v1(wl_display *display, QObject *parent = nullptr);
     void addClientResource(wl_client *client, wl_resource *resource);
@@ -61,6 +61,7 @@ void ForeignToplevelV1::addSurface(SurfaceWrapper *wrapper)
     auto handle = treeland_foreign_toplevel_handle_v1::create(m_manager);
     m_surfaces.insert({ wrapper, std::unique_ptr<treeland_foreign_toplevel_handle_v1>(handle) });
     auto surface = wrapper->shellSurface();
+    m_handlesBySurface.insert(surface, handle);
 
     // initSurface
     surface->safeConnect(&WToplevelSurface::titleChanged, handle, [handle, surface] {
@@ -163,11 +164,9 @@ void ForeignToplevelV1::addSurface(SurfaceWrapper *wrapper)
                 handle->set_parent(nullptr);
                 return;
             }
-            for (const auto &[wrapper, phandle] : m_surfaces) {
-                if (wrapper->shellSurface() == p) {
-                    handle->set_parent(phandle.get());
-                    return;
-                }
+            if (auto phandle = m_handlesBySurface.value(p)) {
+                handle->set_parent(phandle);
+                return;
             }
             qCCritical(qLcTreelandForeignToplevel)
                 << "Xdg toplevel surface " << xdgSurface
@@ -188,11 +187,9 @@ void ForeignToplevelV1::addSurface(SurfaceWrapper *wrapper)
                 handle->set_parent(nullptr);
                 return;
             }
-            for (const auto &[wrapper, phandle] : m_surfaces) {
-                if (wrapper->shellSurface() == p) {
-                    handle->set_parent(phandle.get());
-                    return;
-                }
+            if (auto phandle = m_handlesBySurface.value(p)) {
+                handle->set_parent(phandle);
+                return;
             }
             qCCritical(qLcTreelandForeignToplevel)
                 << "X11 surface " << xwaylandSurface
@@ -210,8 +207,10 @@ void ForeignToplevelV1::addSurface(SurfaceWrapper *wrapper)
                "WXWaylandSurface";
     }
 
-    handle->set_identifier(
-        *reinterpret_cast<const uint32_t *>(surface->surface()->handle()->handle()));
+    const auto identifier =
+        *reinterpret_cast<const uint32_t *>(surface->surface()->handle()->handle());
+    handle->set_identifier(identifier);
+    m_surfacesByIdentifier.insert(identifier, wrapper);
 
     handle->set_title(surface->title());
     handle->set_app_id(surface->appId());
@@ -223,10 +222,13 @@ void ForeignToplevelV1::addSurface(SurfaceWrapper *wrapper)
 
 void ForeignToplevelV1::removeSurface(SurfaceWrapper *wrapper)
 {
-    if (!m_surfaces.count(wrapper)) {
+    auto it = m_surfaces.find(wrapper);
+    if (it == m_surfaces.end()) {
         return;
     }
-    m_surfaces.erase(wrapper);
+    m_surfacesByIdentifier.remove(it->second->identifier);
+    m_handlesBySurface.remove(wrapper->shellSurface());
+    m_surfaces.erase(it);
 }
 
 void ForeignToplevelV1::enterDockPreview(WSurface *relative_surface)
@@ -256,17 +258,12 @@ void ForeignToplevelV1::onDockPreviewContextCreated(treeland_dock_preview_contex
             this,
             [this](treeland_dock_preview_context_v1_preview_event *event) {
                 std::vector<SurfaceWrapper *> surfaces;
+                surfaces.reserve(event->toplevels.size());
                 for (auto toplevelIt = event->toplevels.cbegin();
                      toplevelIt != event->toplevels.cend();
                      ++toplevelIt) {
-                    const uint32_t identifier = *toplevelIt;
-                    for (auto surfaceIt = m_surfaces.cbegin(); surfaceIt != m_surfaces.cend();
-                         ++surfaceIt) {
-                        if (surfaceIt->second->identifier == identifier) {
-                            surfaces.push_back(surfaceIt->first);
-                            break;
-                        }
-                    }
+                    if (auto wrapper = m_surfacesByIdentifier.value(*toplevelIt))
+                        surfaces.push_back(wrapper);
                 };
 
                 Q_EMIT requestDockPreview(surfaces,
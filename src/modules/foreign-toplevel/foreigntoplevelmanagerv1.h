@@ -63,6 +63,8 @@ private Q_SLOTS:
 private:
     treeland_foreign_toplevel_manager_v1 *m_manager = nullptr;
     std::map<SurfaceWrapper *, std::unique_ptr<treeland_foreign_toplevel_handle_v1>> m_surfaces;
+    QHash<uint32_t, SurfaceWrapper *> m_surfacesByIdentifier;
+    QHash<WToplevelSurface *, treeland_foreign_toplevel_handle_v1 *> m_handlesBySurface;
 };
 
 Q_DECLARE_OPAQUE_POINTER(treeland_foreign_toplevel_handle_v1_maximized_event *);
@@ -10,6 +10,7 @@
 #include <qwseat.h>
 
 #include <cassert>
+#include <utility>
 
 using QW_NAMESPACE::qw_display, QW_NAMESPACE::qw_output;
 
@@ -292,40 +293,77 @@ static void treeland_foreign_toplevel_handle_destroy([[maybe_unused]] struct wl_
     wl_resource_destroy(resource);
 }
 
-static void toplevel_idle_send_done(void *data)
+// Roughly one frame at 60Hz, changes within it reach clients as a single burst.
+static constexpr int DoneCoalesceInterval = 16;
+
+static int toplevel_done_timer_handler(void *data)
 {
     auto *toplevel = static_cast<treeland_foreign_toplevel_handle_v1 *>(data);
-    struct wl_resource *resource;
-    wl_resource_for_each(resource, &toplevel->resources)
-    {
-        treeland_foreign_toplevel_handle_v1_send_done(resource);
-    }
-
-    toplevel->idle_source = nullptr;
+    toplevel->done_scheduled = false;
+    toplevel->send_done();
+    return 0;
 }
 
-void treeland_foreign_toplevel_handle_v1::update_idle_source()
+void treeland_foreign_toplevel_handle_v1::schedule_done(bool changed)
 {
-    if (idle_source) {
+    // Coalesced properties are compared against the sent values in send_done() instead.
+    details_changed |= changed;
+    if (done_scheduled || !done_timer) {
         return;
     }
 
-    idle_source = wl_event_loop_add_idle(manager->event_loop, toplevel_idle_send_done, this);
+    done_scheduled = true;
+    wl_event_source_timer_update(done_timer, DoneCoalesceInterval);
 }
 
-void treeland_foreign_toplevel_handle_v1::set_title(const QString &title)
+void treeland_foreign_toplevel_handle_v1::send_done()
 {
-    if (this->title == title)
+    // Only the latest title, app id and state are sent, and only if they differ from what
+    // clients already have.
+    bool changed = std::exchange(details_changed, false);
+    struct wl_resource *resource;
+    if (sent_title != title) {
+        sent_title = title;
+        const QByteArray utf8Title = title.toUtf8();
+        wl_resource_for_each(resource, &this->resources)
+        {
+            treeland_foreign_toplevel_handle_v1_send_title(resource, utf8Title);
+        }
+        changed = true;
+    }
+
+    if (sent_app_id != app_id) {
+        sent_app_id = app_id;
+        const QByteArray localAppId = app_id.toLocal8Bit();
+        wl_resource_for_each(resource, &this->resources)
+        {
+            treeland_foreign_toplevel_handle_v1_send_app_id(resource, localAppId);
+        }
+        changed = true;
+    }
+
+    if (sent_state != state) {
+        sent_state = state;
+        send_state();
+        changed = true;
+    }
+
+    if (!changed) {
         return;
-    this->title = title;
+    }
 
-    struct wl_resource *resource;
     wl_resource_for_each(resource, &this->resources)
     {
-        treeland_foreign_toplevel_handle_v1_send_title(resource, title.toUtf8());
+        treeland_foreign_toplevel_handle_v1_send_done(resource);
     }
+}
 
-    update_idle_source();
+void treeland_foreign_toplevel_handle_v1::set_title(const QString &title)
+{
+    if (this->title == title)
+        return;
+    this->title = title;
+    schedule_done(false);
 }
 
 void treeland_foreign_toplevel_handle_v1::set_app_id(const QString &app_id)
@@ -333,14 +371,7 @@ void treeland_foreign_toplevel_handle_v1::set_app_id(const QString &app_id)
     if (this->app_id == app_id)
         return;
     this->app_id = app_id;
-
-    struct wl_resource *resource;
-    wl_resource_for_each(resource, &this->resources)
-    {
-        treeland_foreign_toplevel_handle_v1_send_app_id(resource, app_id.toLocal8Bit());
-    }
-
-    update_idle_source();
+    schedule_done(false);
 }
 
 void treeland_foreign_toplevel_handle_v1::set_pid(const pid_t pid)
@@ -353,7 +384,7 @@ void treeland_foreign_toplevel_handle_v1::set_pid(const pid_t pid)
         treeland_foreign_toplevel_handle_v1_send_pid(resource, pid);
     }
 
-    update_idle_source();
+    schedule_done();
 }
 
 void treeland_foreign_toplevel_handle_v1::set_identifier(uint32_t identifier)
@@ -366,7 +397,7 @@ void treeland_foreign_toplevel_handle_v1::set_identifier(uint32_t identifier)
         treeland_foreign_toplevel_handle_v1_send_identifier(resource, identifier);
     }
 
-    update_idle_source();
+    schedule_done();
 }
 
 static void send_output_to_resource(wl_resource *resource, wlr_output *output, bool enter)
@@ -394,7 +425,7 @@ void treeland_foreign_toplevel_handle_v1::send_output(qw_output *output, bool en
         send_output_to_resource(resource, output->handle(), enter);
     }
 
-    update_idle_source();
+    schedule_done();
 }
 
 void treeland_foreign_toplevel_handle_v1::output_enter(qw_output *output)
@@ -421,7 +452,7 @@ void treeland_foreign_toplevel_handle_v1::output_enter(qw_output *output)
             }
         }
 
-        toplevel_output.toplevel->update_idle_source();
+        toplevel_output.toplevel->schedule_done();
     });
 
     connect(output, &qw_output::before_destroy, this, [toplevel_output]() {
@@ -496,7 +527,6 @@ void treeland_foreign_toplevel_handle_v1::send_state()
     }
 
     wl_array_release(&states);
-    update_idle_source();
 }
 
 void treeland_foreign_toplevel_handle_v1::set_maximized(bool maximized)
@@ -505,7 +535,7 @@ void treeland_foreign_toplevel_handle_v1::set_maximized(bool maximized)
         return;
     }
     state.setFlag(State::Maximized, maximized);
-    send_state();
+    schedule_done(false);
 }
 
 void treeland_foreign_toplevel_handle_v1::set_minimized(bool minimized)
@@ -514,7 +544,7 @@ void treeland_foreign_toplevel_handle_v1::set_minimized(bool minimized)
         return;
     }
     state.setFlag(State::Minimized, minimized);
-    send_state();
+    schedule_done(false);
 }
 
 void treeland_foreign_toplevel_handle_v1::set_activated(bool activated)
@@ -523,7 +553,7 @@ void treeland_foreign_toplevel_handle_v1::set_activated(bool activated)
         return;
     }
     state.setFlag(State::Activated, activated);
-    send_state();
+    schedule_done(false);
 }
 
 void treeland_foreign_toplevel_handle_v1::set_fullscreen(bool fullscreen)
@@ -532,7 +562,7 @@ void treeland_foreign_toplevel_handle_v1::set_fullscreen(bool fullscreen)
         return;
     }
     state.setFlag(State::Fullscreen, fullscreen);
-    send_state();
+    schedule_done(false);
 }
 
 static void toplevel_resource_send_parent(struct wl_resource *toplevel_resource,
@@ -566,7 +596,7 @@ void treeland_foreign_toplevel_handle_v1::set_parent(treeland_foreign_toplevel_h
         toplevel_resource_send_parent(toplevel_resource, parent);
     }
     this->parent = parent;
-    update_idle_source();
+    schedule_done();
 }
 
 void treeland_dock_preview_context_v1::enter()
@@ -603,8 +633,8 @@ treeland_foreign_toplevel_handle_v1::~treeland_foreign_toplevel_handle_v1()
 
     outputs.clear();
 
-    if (idle_source) {
-        wl_event_source_remove(idle_source);
+    if (done_timer) {
+        wl_event_source_remove(done_timer);
     }
 
     /* need to ensure no other toplevels hold a pointer to this one as
@@ -726,6 +756,8 @@ treeland_foreign_toplevel_handle_v1 *treeland_foreign_toplevel_handle_v1::create
             });
 
     toplevel->manager = manager;
+    toplevel->done_timer =
+        wl_event_loop_add_timer(manager->event_loop, toplevel_done_timer_handler, toplevel);
 
     wl_list_init(&toplevel->resources);
 
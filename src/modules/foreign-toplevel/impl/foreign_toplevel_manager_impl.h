@@ -68,6 +68,7 @@ Q_SIGNALS:
 };
 
 static void toplevel_handle_output_bind(struct wl_listener *listener, void *data);
+static int toplevel_done_timer_handler(void *data);
 struct treeland_foreign_toplevel_handle_v1_maximized_event;
 struct treeland_foreign_toplevel_handle_v1_minimized_event;
 struct treeland_foreign_toplevel_handle_v1_activated_event;
@@ -91,7 +92,8 @@ public:
     ~treeland_foreign_toplevel_handle_v1();
     treeland_foreign_toplevel_manager_v1 *manager{ nullptr };
     wl_list resources;
-    wl_event_source *idle_source{ nullptr };
+    // Changes are flushed to clients at most once per frame, see schedule_done().
+    wl_event_source *done_timer{ nullptr };
 
     QString title;
     QString app_id;
@@ -129,11 +131,20 @@ Q_SIGNALS:
     void rectangleChanged(treeland_foreign_toplevel_handle_v1_set_rectangle_event *event);
 
 private:
-    void update_idle_source();
+    void schedule_done(bool changed = true);
+    void send_done();
     void send_state();
     void send_output(QW_NAMESPACE::qw_output *output, bool enter);
 
+    // Title, app id and state as last sent by send_done().
+    QString sent_title;
+    QString sent_app_id;
+    States sent_state;
+    bool done_scheduled{ false };
+    bool details_changed{ false };
+
     friend void toplevel_handle_output_bind(struct wl_listener *listener, void *data);
+    friend int toplevel_done_timer_handler(void *data);
 };
 
 struct wlr_seat;
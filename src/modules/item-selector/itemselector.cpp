@@ -62,6 +62,26 @@ WOutputItem *ItemSelector::outputItem() const
     return m_outputItem;
 }
 
+QList<WOutputItem *> ItemSelector::outputItems() const
+{
+    QList<WOutputItem *> items;
+    for (const auto &item : std::as_const(m_outputItems)) {
+        if (item)
+            items.append(item);
+    }
+    return items;
+}
+
+QList<QQuickItem *> ItemSelector::selectableItems() const
+{
+    QList<QQuickItem *> items;
+    for (const auto &item : std::as_const(m_selectableItems)) {
+        if (item)
+            items.append(item);
+    }
+    return items;
+}
+
 void ItemSelector::setHoveredItem(QQuickItem *newHoveredItem)
 {
     if (m_hoveredItem == newHoveredItem)
@@ -110,6 +130,7 @@ void ItemSelector::updateSelectableItems()
     if (!window())
         return;
     auto renderWindow = qobject_cast<WOutputRenderWindow *>(window());
+    m_outputItems.clear();
     m_selectableItems = WOutputRenderWindow::paintOrderItemList(
         renderWindow->contentItem(),
         [this](QQuickItem *item) -> bool {
@@ -37,6 +37,9 @@ public:
     QRectF selectionRegion() const;
     QQuickItem *hoveredItem() const;
     WAYLIB_SERVER_NAMESPACE::WOutputItem *outputItem() const;
+    QList<WAYLIB_SERVER_NAMESPACE::WOutputItem *> outputItems() const;
+    // Items accepted by filters, in paint order.
+    QList<QQuickItem *> selectableItems() const;
     void setSelectionTypeHint(ItemTypes newSelectionTypeHint);
     ItemTypes selectionTypeHint() const;
 
@@ -30,27 +30,34 @@ void ShortcutV1::onNewContext(uid_t uid, treeland_shortcut_context_v1 *context)
         context->send_shortcut();
     });
 
-    connect(context, &treeland_shortcut_context_v1::before_destroy, this, [this, uid, action] {
-        m_actions.remove(uid);
+    // Key events are matched one combination at a time, multi-chord sequences never match.
+    const QKeySequence sequence = action->shortcut();
+    const int key = sequence.count() == 1 ? sequence[0].toCombined() : 0;
+
+    connect(context, &treeland_shortcut_context_v1::before_destroy, this, [this, uid, key, action] {
+        auto it = m_bindings.find(uid);
+        if (it != m_bindings.end() && it->value(key) == action) {
+            it->remove(key);
+            if (it->isEmpty())
+                m_bindings.erase(it);
+        }
         action->deleteLater();
     });
 
-    if (!m_actions.count(uid)) {
-        m_actions[uid] = {};
-    }
+    if (!key)
+        return;
 
-    auto find = std::ranges::find_if(m_actions[uid], [action](QAction *a) {
-        return a->shortcut() == action->shortcut();
-    });
-
-    if (find == m_actions[uid].end()) {
-        m_actions[uid].push_back(action);
-    }
+    auto &bindings = m_bindings[uid];
+    if (!bindings.contains(key))
+        bindings.insert(key, action);
 }
 
-std::vector<QAction *> ShortcutV1::actions(uid_t uid) const
+QAction *ShortcutV1::findAction(uid_t uid, QKeyCombination key) const
 {
-    return m_actions[uid];
+    const auto it = m_bindings.constFind(uid);
+    if (it == m_bindings.cend())
+        return nullptr;
+    return it->value(key.toCombined());
 }
 
 void ShortcutV1::create(WServer *server)
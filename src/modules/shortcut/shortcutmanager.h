@@ -5,6 +5,7 @@
 
 #include <wserver.h>
 
+#include <QHash>
 #include <QObject>
 #include <QQmlEngine>
 
@@ -36,7 +37,8 @@ public:
     explicit ShortcutV1(QObject *parent = nullptr);
     QByteArrayView interfaceName() const override;
 
-    std::vector<QAction *> actions(uid_t uid) const;
+    // Action bound to the single key combination for uid, or nullptr.
+    QAction *findAction(uid_t uid, QKeyCombination key) const;
 
 protected:
     void create(WServer *server) override;
@@ -48,7 +50,8 @@ private Q_SLOTS:
 
 private:
     treeland_shortcut_manager_v1 *m_manager = nullptr;
-    QMap<uid_t, std::vector<QAction *>> m_actions;
+    // Per user bindings keyed by QKeyCombination::toCombined(), maintained in onNewContext.
+    QHash<uid_t, QHash<int, QAction *>> m_bindings;
 };
 
 Q_DECLARE_FLAGS(MetaKeyChecks, ShortcutV1::MetaKeyCheck)
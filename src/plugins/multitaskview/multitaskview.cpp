@@ -12,7 +12,8 @@
 #include <woutputitem.h>
 #include <woutputrenderwindow.h>
 
-#include <QtConcurrentMap>
+#include <cmath>
+#include <numeric>
 
 WAYLIB_SERVER_USE_NAMESPACE
 
@@ -96,6 +97,9 @@ void MultitaskviewSurfaceModel::initializeModel()
         return;
     beginResetModel();
     m_data.clear();
+    // Rows refer to the old data, next layout must be a full one.
+    m_rows.clear();
+    m_pendingRelayoutFrom = -1;
     QList<SurfaceWrapper *> surfaces(workspace()->surfaces());
     surfaces << Helper::instance()->workspace()->showOnAllWorkspaceModel()->surfaces();
     for (const auto &surface : std::as_const(surfaces)) {
@@ -103,6 +107,7 @@ void MultitaskviewSurfaceModel::initializeModel()
             continue;
         if (surface->ownsOutput() == output()) {
             if (surfaceReady(surface)) {
+                monitorSurfaceGeometry(surface);
                 m_data.push_back(std::make_shared<SurfaceModelData>(
                     surface,
                     surfaceGeometry(surface)
@@ -124,12 +129,18 @@ void MultitaskviewSurfaceModel::initializeModel()
                 this,
                 &MultitaskviewSurfaceModel::handleSurfaceStateChanged,
                 Qt::UniqueConnection);
+        connect(surface->shellSurface(),
+                &WToplevelSurface::appIdChanged,
+                this,
+                &MultitaskviewSurfaceModel::updateSurfaceIndexes,
+                Qt::UniqueConnection);
     }
     std::sort(m_data.begin(),
               m_data.end(),
               [this](const ModelDataPtr &lhs, const ModelDataPtr &rhs) -> bool {
                   return laterActiveThan(lhs->wrapper, rhs->wrapper);
               });
+    updateSurfaceIndexes();
     doUpdateZOrder(m_data);
     endResetModel();
     m_modelReady = true;
@@ -196,9 +207,16 @@ bool MultitaskviewSurfaceModel::modelReady() const
 
 void MultitaskviewSurfaceModel::calcLayout()
 {
+    m_pendingRelayoutFrom = -1;
     doCalculateLayout(m_data);
+    commitLayout();
+}
+
+void MultitaskviewSurfaceModel::commitLayout()
+{
     auto [beginIndex, endIndex] = commitAndGetUpdateRange(m_data);
     if (beginIndex <= endIndex) {
+        Q_ASSERT(beginIndex < m_data.size());
         Q_EMIT dataChanged(index(beginIndex),
                            index(endIndex),
                            { GeometryRole,
@@ -212,6 +230,42 @@ void MultitaskviewSurfaceModel::calcLayout()
     Q_EMIT contentHeightChanged();
 }
 
+void MultitaskviewSurfaceModel::relayout(const QList<ModelDataPtr> &rawData, int from)
+{
+    if (!tryRelayout(rawData, from))
+        doCalculateLayout(rawData);
+}
+
+void MultitaskviewSurfaceModel::scheduleRelayout(int from)
+{
+    // Coalesce changes in one event loop iteration, e.g. a client spamming resizes.
+    if (m_pendingRelayoutFrom < 0) {
+        QMetaObject::invokeMethod(this,
+                                  &MultitaskviewSurfaceModel::processPendingRelayout,
+                                  Qt::QueuedConnection);
+        m_pendingRelayoutFrom = from;
+    } else {
+        m_pendingRelayoutFrom = std::min(m_pendingRelayoutFrom, from);
+    }
+}
+
+int MultitaskviewSurfaceModel::takePendingRelayout(int from)
+{
+    // Pending index is before any index shifted by the change, or covered by `from`.
+    if (m_pendingRelayoutFrom >= 0)
+        from = std::min(from, m_pendingRelayoutFrom);
+    m_pendingRelayoutFrom = -1;
+    return from;
+}
+
+void MultitaskviewSurfaceModel::processPendingRelayout()
+{
+    if (m_pendingRelayoutFrom < 0 || !output() || m_layoutArea.isEmpty())
+        return;
+    relayout(m_data, takePendingRelayout(m_data.size()));
+    commitLayout();
+}
+
 void MultitaskviewSurfaceModel::updateZOrder()
 {
     doUpdateZOrder(m_data);
@@ -222,34 +276,14 @@ int MultitaskviewSurfaceModel::prevSameAppIndex(int index)
 {
     if (index < 0 || index >= count())
         return -1;
-    auto circularPrev = [this](int i) {
-        return (i + count() - 1) % count();
-    };
-    auto i = circularPrev(index);
-    for (; i != index; i = circularPrev(i)) {
-        if (m_data[i]->wrapper->shellSurface()->appId()
-            == m_data[index]->wrapper->shellSurface()->appId()) {
-            break;
-        }
-    }
-    return i;
+    return m_data[index]->prevSameAppIndex;
 }
 
 int MultitaskviewSurfaceModel::nextSameAppIndex(int index)
 {
     if (index < 0 || index >= count())
         return -1;
-    auto circularNext = [this](int i) {
-        return (i + 1) % count();
-    };
-    auto i = circularNext(index);
-    for (; i != index; i = circularNext(i)) {
-        if (m_data[i]->wrapper->shellSurface()->appId()
-            == m_data[index]->wrapper->shellSurface()->appId()) {
-            break;
-        }
-    }
-    return i;
+    return m_data[index]->nextSameAppIndex;
 }
 
 QRectF MultitaskviewSurfaceModel::layoutArea() const
@@ -266,28 +300,23 @@ void MultitaskviewSurfaceModel::setLayoutArea(const QRectF &newLayoutArea)
     emit layoutAreaChanged();
 }
 
-bool MultitaskviewSurfaceModel::tryLayout(const QList<ModelDataPtr> &rawData,
-                                          qreal rowH,
-                                          bool ignoreOverlap)
+void MultitaskviewSurfaceModel::packRows(const QList<ModelDataPtr> &rawData,
+                                         int from,
+                                         qreal rowH,
+                                         QList<QList<ModelDataPtr>> &rows)
 {
-    int nrows = 1;
-    qreal acc = 0;
     auto devicePixelRatio = output()->outputItem()->devicePixelRatio();
-    auto topContentMargin =
-        TreelandConfig::ref().multitaskviewTopContentMargin() / devicePixelRatio;
-    auto bottomContentMargin =
-        TreelandConfig::ref().multitaskviewBottomContentMargin() / devicePixelRatio;
     auto cellPadding = TreelandConfig::ref().multitaskviewCellPadding() / devicePixelRatio;
     auto horizontalMargin =
         TreelandConfig::ref().multitaskviewHorizontalMargin() / devicePixelRatio;
+    auto loadFactor = TreelandConfig::ref().multitaskviewLoadFactor();
     auto availWidth = std::max(0.0, layoutArea().width() - 2 * horizontalMargin);
-    auto availHeight =
-        std::max(0.0, layoutArea().height() - topContentMargin - bottomContentMargin);
     if (availWidth <= 0)
-        return false;
-    QList<QList<ModelDataPtr>> rowstmp;
+        return;
+    qreal acc = 0;
     QList<ModelDataPtr> currow;
-    for (auto &modelData : rawData) {
+    for (auto i = from; i < rawData.size(); ++i) {
+        const auto &modelData = rawData[i];
         auto surface = modelData->wrapper;
         auto whRatio = surface->width() / surface->height();
         modelData->pendingPadding = surface->height() < (rowH - 2 * cellPadding);
@@ -299,10 +328,9 @@ bool MultitaskviewSurfaceModel::tryLayout(const QList<ModelDataPtr> &rawData,
         if (newAcc <= availWidth) {
             acc = newAcc;
             currow.append(modelData);
-        } else if (newAcc / availWidth > TreelandConfig::ref().multitaskviewLoadFactor()) {
+        } else if (newAcc / availWidth > loadFactor) {
             acc = curW;
-            nrows++;
-            rowstmp.append(currow);
+            rows.append(currow);
             currow = { modelData };
         } else {
             // Just scale the last element
@@ -312,10 +340,31 @@ bool MultitaskviewSurfaceModel::tryLayout(const QList<ModelDataPtr> &rawData,
             acc = newAcc;
         }
     }
+    if (currow.length()) {
+        rows.append(currow);
+    }
+}
+
+bool MultitaskviewSurfaceModel::tryLayout(const QList<ModelDataPtr> &rawData,
+                                          qreal rowH,
+                                          bool ignoreOverlap)
+{
+    auto devicePixelRatio = output()->outputItem()->devicePixelRatio();
+    auto topContentMargin =
+        TreelandConfig::ref().multitaskviewTopContentMargin() / devicePixelRatio;
+    auto bottomContentMargin =
+        TreelandConfig::ref().multitaskviewBottomContentMargin() / devicePixelRatio;
+    auto horizontalMargin =
+        TreelandConfig::ref().multitaskviewHorizontalMargin() / devicePixelRatio;
+    auto availWidth = std::max(0.0, layoutArea().width() - 2 * horizontalMargin);
+    auto availHeight =
+        std::max(0.0, layoutArea().height() - topContentMargin - bottomContentMargin);
+    if (availWidth <= 0)
+        return false;
+    QList<QList<ModelDataPtr>> rowstmp;
+    packRows(rawData, 0, rowH, rowstmp);
+    const auto nrows = std::max<qsizetype>(1, rowstmp.size());
     if (nrows * rowH <= availHeight || ignoreOverlap) {
-        if (currow.length()) {
-            rowstmp.append(currow);
-        }
         m_rowHeight = rowH;
         m_rows = rowstmp;
         return true;
@@ -323,7 +372,43 @@ bool MultitaskviewSurfaceModel::tryLayout(const QList<ModelDataPtr> &rawData,
     return false;
 }
 
-void MultitaskviewSurfaceModel::calcDisplayPos(const QList<ModelDataPtr> &rawData)
+bool MultitaskviewSurfaceModel::tryRelayout(const QList<ModelDataPtr> &rawData, int from)
+{
+    if (m_rows.isEmpty() || m_rowHeight <= 0)
+        return false;
+    // Rows before the one holding `from` only depend on the data before it, keep them.
+    int row = 0;
+    int start = 0;
+    while (row < m_rows.size() - 1 && start + m_rows[row].size() <= from) {
+        start += m_rows[row].size();
+        ++row;
+    }
+    QList<QList<ModelDataPtr>> rows = m_rows.mid(0, row);
+    packRows(rawData, start, m_rowHeight, rows);
+    if (rows.size() < m_rows.size()) {
+        // Fewer rows may leave room for higher ones, that needs a full layout.
+        return false;
+    }
+    if (rows.size() > m_rows.size()) {
+        auto devicePixelRatio = output()->outputItem()->devicePixelRatio();
+        auto topContentMargin =
+            TreelandConfig::ref().multitaskviewTopContentMargin() / devicePixelRatio;
+        auto bottomContentMargin =
+            TreelandConfig::ref().multitaskviewBottomContentMargin() / devicePixelRatio;
+        auto availHeight =
+            std::max(0.0, layoutArea().height() - topContentMargin - bottomContentMargin);
+        if (rows.size() * m_rowHeight > availHeight)
+            return false;
+    }
+    const bool sameRowCount = rows.size() == m_rows.size();
+    m_rows = rows;
+    // Vertical position of all rows changes with row count, otherwise only rows from the
+    // previous one, whose down indexes point into the re-packed row, need updates.
+    calcDisplayPos(rawData, sameRowCount ? std::max(0, row - 1) : 0);
+    return true;
+}
+
+void MultitaskviewSurfaceModel::calcDisplayPos(const QList<ModelDataPtr> &rawData, int fromRow)
 {
     auto devicePixelRatio = output()->outputItem()->devicePixelRatio();
     auto topContentMargin =
@@ -339,30 +424,38 @@ void MultitaskviewSurfaceModel::calcDisplayPos(const QList<ModelDataPtr> &rawDat
     auto contentHeight = m_rows.length() * m_rowHeight;
     auto curY = std::max(availHeight - contentHeight, 0.0) / 2 + topContentMargin;
     const auto hCenter = availWidth / 2;
-    for (auto i = 0; i < m_rows.size(); ++i) {
-        auto row = m_rows[i];
-        const auto totW = QtConcurrent::blockingMappedReduced(
-            row,
-            [cellPadding](ModelDataPtr data) {
-                return data->pendingGeometry.width() + 2 * cellPadding;
-            },
-            [](qreal &acc, const qreal &cur) {
-                acc += cur;
-            });
+    // rawData may be pending data rather than m_data, index it once for neighbour lookups.
+    QHash<const SurfaceModelData *, int> indexes;
+    indexes.reserve(rawData.size());
+    for (int i = 0; i < rawData.size(); ++i)
+        indexes.insert(rawData[i].get(), i);
+    auto indexOf = [&indexes](const ModelDataPtr &modelData) {
+        return indexes.value(modelData.get(), -1);
+    };
+    curY += fromRow * m_rowHeight;
+    for (auto i = fromRow; i < m_rows.size(); ++i) {
+        const auto &row = m_rows[i];
+        const auto totW = std::accumulate(row.cbegin(),
+                                          row.cend(),
+                                          qreal(0),
+                                          [cellPadding](qreal acc, const ModelDataPtr &data) {
+                                              return acc + data->pendingGeometry.width()
+                                                  + 2 * cellPadding;
+                                          });
         auto curX = hCenter - totW / 2 + cellPadding + horizontalMargin;
         for (auto j = 0; j < row.size(); ++j) {
             auto window = row[j];
             window->pendingGeometry.moveLeft(curX);
             window->pendingGeometry.moveTop(curY);
             window->pendingGeometry.setHeight(m_rowHeight - 2 * cellPadding);
-            window->pendingLeftIndex = rawData.indexOf(row[(j - 1 + row.size()) % row.size()]);
-            window->pendingRightIndex = rawData.indexOf(row[(j + 1) % row.size()]);
-            auto lastRow = m_rows[std::max(0, i - 1)];
+            window->pendingLeftIndex = indexOf(row[(j - 1 + row.size()) % row.size()]);
+            window->pendingRightIndex = indexOf(row[(j + 1) % row.size()]);
+            const auto &lastRow = m_rows[std::max(0, i - 1)];
             auto lastRowIndex = std::min(static_cast<int>(lastRow.size()) - 1, j);
-            window->pendingUpIndex = rawData.indexOf(lastRow[lastRowIndex]);
-            auto nextRow = m_rows[std::min(static_cast<int>(m_rows.size()) - 1, i + 1)];
+            window->pendingUpIndex = indexOf(lastRow[lastRowIndex]);
+            const auto &nextRow = m_rows[std::min(static_cast<int>(m_rows.size()) - 1, i + 1)];
             auto nextRowIndex = std::min(static_cast<int>(nextRow.size()) - 1, j);
-            window->pendingDownIndex = rawData.indexOf(nextRow[nextRowIndex]);
+            window->pendingDownIndex = indexOf(nextRow[nextRowIndex]);
             curX += window->pendingGeometry.width() + 2 * cellPadding;
         }
         curY += m_rowHeight;
@@ -378,15 +471,34 @@ void MultitaskviewSurfaceModel::doCalculateLayout(const QList<ModelDataPtr> &raw
                  static_cast<qreal>(TreelandConfig::ref().normalWindowHeight() / devicePixelRatio));
     auto minWindowHeight = TreelandConfig::ref().minMultitaskviewSurfaceHeight() / devicePixelRatio;
     auto windowHeightStep = TreelandConfig::ref().windowHeightStep() / devicePixelRatio;
-    auto rowH = maxWindowHeight;
-    while (rowH > minWindowHeight) {
-        if (tryLayout(rawData, rowH)) {
-            break;
+    // Candidate row heights are maxWindowHeight - k * windowHeightStep above minWindowHeight.
+    // Lower rows never need more space, so bisect for the first k that fits.
+    int candidates = 0;
+    if (maxWindowHeight > minWindowHeight) {
+        candidates = windowHeightStep > 0
+            ? static_cast<int>(std::ceil((maxWindowHeight - minWindowHeight) / windowHeightStep))
+            : 1;
+    }
+    auto rowHeightAt = [=](int k) {
+        return maxWindowHeight - k * windowHeightStep;
+    };
+    int low = 0, high = candidates, lastTried = -1;
+    bool lastFits = false;
+    while (low < high) {
+        const int mid = (low + high) / 2;
+        lastTried = mid;
+        lastFits = tryLayout(rawData, rowHeightAt(mid));
+        if (lastFits) {
+            high = mid;
+        } else {
+            low = mid + 1;
         }
-        rowH -= windowHeightStep;
     }
-    if (rowH < minWindowHeight) {
+    if (low == candidates) {
         tryLayout(rawData, minWindowHeight, true);
+    } else if (lastTried != low || !lastFits) {
+        // Failed attempts leave their widths in pending geometry, redo the chosen one.
+        tryLayout(rawData, rowHeightAt(low));
     }
     calcDisplayPos(rawData);
 }
@@ -403,9 +515,12 @@ void MultitaskviewSurfaceModel::doUpdateZOrder(const QList<ModelDataPtr> &rawDat
                 return false;
             }
         });
-    std::for_each(rawData.begin(), rawData.end(), [surfaces, this](ModelDataPtr modelData) {
-        modelData->zorder = surfaces.indexOf(modelData->wrapper);
-    });
+    QHash<QQuickItem *, int> paintOrder;
+    paintOrder.reserve(surfaces.size());
+    for (int i = 0; i < surfaces.size(); ++i)
+        paintOrder.insert(surfaces[i], i);
+    for (const auto &modelData : rawData)
+        modelData->zorder = paintOrder.value(modelData->wrapper, -1);
 }
 
 std::pair<int, int> MultitaskviewSurfaceModel::commitAndGetUpdateRange(
@@ -437,7 +552,9 @@ void MultitaskviewSurfaceModel::handleWrapperGeometryChanged()
 {
     auto wrapper = qobject_cast<SurfaceWrapper *>(sender());
     Q_ASSERT(wrapper);
-    if (surfaceReady(wrapper)) {
+    if (const int i = indexOfSurface(wrapper); i >= 0) {
+        scheduleRelayout(i);
+    } else if (surfaceReady(wrapper)) {
         addReadySurface(wrapper);
     }
 }
@@ -459,15 +576,11 @@ void MultitaskviewSurfaceModel::handleSurfaceStateChanged()
 {
     auto surface = qobject_cast<SurfaceWrapper *>(sender());
     Q_ASSERT(surface);
-    auto dataPtr =
-        std::find_if(m_data.begin(), m_data.end(), [this, surface](const ModelDataPtr &modelData) {
-            return modelData->wrapper == surface;
-        });
-    if (dataPtr == m_data.end())
+    const int i = indexOfSurface(surface);
+    if (i < 0)
         return;
-    if (surface->isMinimized() != (*dataPtr)->minimized) {
-        (*dataPtr)->minimized = surface->isMinimized();
-        int i = std::distance(m_data.begin(), dataPtr);
+    if (surface->isMinimized() != m_data[i]->minimized) {
+        m_data[i]->minimized = surface->isMinimized();
         Q_EMIT dataChanged(index(i), index(i), { MinimizedRole });
     }
 }
@@ -502,6 +615,11 @@ void MultitaskviewSurfaceModel::handleSurfaceAdded(SurfaceWrapper *surface)
             this,
             &MultitaskviewSurfaceModel::handleSurfaceStateChanged,
             Qt::UniqueConnection);
+    connect(surface->shellSurface(),
+            &WToplevelSurface::appIdChanged,
+            this,
+            &MultitaskviewSurfaceModel::updateSurfaceIndexes,
+            Qt::UniqueConnection);
     if (surface->ownsOutput() == output()) {
         if (surfaceReady(surface)) {
             addReadySurface(surface);
@@ -513,15 +631,12 @@ void MultitaskviewSurfaceModel::handleSurfaceAdded(SurfaceWrapper *surface)
 
 void MultitaskviewSurfaceModel::handleSurfaceRemoved(SurfaceWrapper *surface)
 {
-    auto toBeRemovedIt =
-        std::find_if(m_data.begin(), m_data.end(), [surface](ModelDataPtr modelData) {
-            return modelData->wrapper == surface;
-        });
-    if (toBeRemovedIt == m_data.end())
+    const int toRemove = indexOfSurface(surface);
+    if (toRemove < 0)
         return;
-    int toRemove = std::distance(m_data.begin(), toBeRemovedIt);
     beginRemoveRows({}, toRemove, toRemove);
     m_data.remove(toRemove);
+    updateSurfaceIndexes();
     disconnect(surface,
                &SurfaceWrapper::ownsOutputChanged,
                this,
@@ -530,23 +645,22 @@ void MultitaskviewSurfaceModel::handleSurfaceRemoved(SurfaceWrapper *surface)
                &SurfaceWrapper::surfaceStateChanged,
                this,
                &MultitaskviewSurfaceModel::handleSurfaceStateChanged);
+    disconnect(surface->shellSurface(),
+               &WToplevelSurface::appIdChanged,
+               this,
+               &MultitaskviewSurfaceModel::updateSurfaceIndexes);
+    disconnect(surface,
+               &SurfaceWrapper::normalGeometryChanged,
+               this,
+               &MultitaskviewSurfaceModel::handleWrapperGeometryChanged);
+    disconnect(surface,
+               &SurfaceWrapper::geometryChanged,
+               this,
+               &MultitaskviewSurfaceModel::handleWrapperGeometryChanged);
     endRemoveRows();
-    doCalculateLayout(m_data);
-    auto [beginIndex, endIndex] = commitAndGetUpdateRange(m_data);
-    if (beginIndex <= endIndex) {
-        Q_ASSERT(beginIndex < m_data.size());
-        Q_EMIT dataChanged(index(beginIndex),
-                           index(endIndex),
-                           { GeometryRole,
-                             PaddingRole,
-                             UpIndexRole,
-                             DownIndexRole,
-                             LeftIndexRole,
-                             RightIndexRole });
-    }
-    Q_EMIT rowsChanged();
+    relayout(m_data, takePendingRelayout(toRemove));
+    commitLayout();
     Q_EMIT countChanged();
-    Q_EMIT contentHeightChanged();
 }
 
 void MultitaskviewSurfaceModel::addReadySurface(SurfaceWrapper *surface)
@@ -554,18 +668,11 @@ void MultitaskviewSurfaceModel::addReadySurface(SurfaceWrapper *surface)
     Q_ASSERT_X(surfaceReady(surface),
                __func__,
                "Surface wrapper should be ready before adding to multitaskview model.");
-    disconnect(surface,
-               &SurfaceWrapper::normalGeometryChanged,
-               this,
-               &MultitaskviewSurfaceModel::handleWrapperGeometryChanged);
-    disconnect(surface,
-               &SurfaceWrapper::geometryChanged,
-               this,
-               &MultitaskviewSurfaceModel::handleWrapperGeometryChanged);
     disconnect(surface->surface(),
                &WSurface::mappedChanged,
                this,
                &MultitaskviewSurfaceModel::handleSurfaceMappedChanged);
+    monitorSurfaceGeometry(surface);
     auto toBeInserted =
         std::make_shared<SurfaceModelData>(surface,
                                            surfaceGeometry(surface)
@@ -580,7 +687,7 @@ void MultitaskviewSurfaceModel::addReadySurface(SurfaceWrapper *surface)
     auto insertedIt = pendingData.insert(it, toBeInserted);
     int insertedIndex = std::distance(pendingData.begin(), insertedIt);
     Q_ASSERT(insertedIndex >= 0 && insertedIndex < pendingData.size());
-    doCalculateLayout(pendingData);
+    relayout(pendingData, takePendingRelayout(insertedIndex));
     auto [beginIndex, endIndex] = commitAndGetUpdateRange(m_data);
     if (beginIndex <= endIndex) {
         Q_ASSERT(beginIndex < m_data.size());
@@ -597,6 +704,7 @@ void MultitaskviewSurfaceModel::addReadySurface(SurfaceWrapper *surface)
     beginInsertRows({}, insertedIndex, insertedIndex);
     m_data = pendingData;
     pendingData.clear();
+    updateSurfaceIndexes();
     endInsertRows();
     Q_EMIT rowsChanged();
     Q_EMIT countChanged();
@@ -606,6 +714,16 @@ void MultitaskviewSurfaceModel::addReadySurface(SurfaceWrapper *surface)
 void MultitaskviewSurfaceModel::monitorUnreadySurface(SurfaceWrapper *surface)
 {
     Q_ASSERT_X(!surfaceReady(surface), __func__, "Surface is ready.");
+    monitorSurfaceGeometry(surface);
+    connect(surface->surface(),
+            &WSurface::mappedChanged,
+            this,
+            &MultitaskviewSurfaceModel::handleSurfaceMappedChanged,
+            Qt::UniqueConnection);
+}
+
+void MultitaskviewSurfaceModel::monitorSurfaceGeometry(SurfaceWrapper *surface)
+{
     connect(surface,
             &SurfaceWrapper::normalGeometryChanged,
             this,
@@ -616,11 +734,28 @@ void MultitaskviewSurfaceModel::monitorUnreadySurface(SurfaceWrapper *surface)
             this,
             &MultitaskviewSurfaceModel::handleWrapperGeometryChanged,
             Qt::UniqueConnection);
-    connect(surface->surface(),
-            &WSurface::mappedChanged,
-            this,
-            &MultitaskviewSurfaceModel::handleSurfaceMappedChanged,
-            Qt::UniqueConnection);
+}
+
+void MultitaskviewSurfaceModel::updateSurfaceIndexes()
+{
+    m_surfaceIndexes.clear();
+    m_surfaceIndexes.reserve(m_data.size());
+    QHash<QString, QList<int>> appRows;
+    for (int i = 0; i < m_data.size(); ++i) {
+        m_surfaceIndexes.insert(m_data[i]->wrapper, i);
+        appRows[m_data[i]->wrapper->shellSurface()->appId()].append(i);
+    }
+    for (const auto &rows : std::as_const(appRows)) {
+        for (int j = 0; j < rows.size(); ++j) {
+            m_data[rows[j]]->prevSameAppIndex = rows[(j + rows.size() - 1) % rows.size()];
+            m_data[rows[j]]->nextSameAppIndex = rows[(j + 1) % rows.size()];
+        }
+    }
+}
+
+int MultitaskviewSurfaceModel::indexOfSurface(SurfaceWrapper *surface) const
+{
+    return m_surfaceIndexes.value(surface, -1);
 }
 
 bool MultitaskviewSurfaceModel::surfaceReady(SurfaceWrapper *surface)
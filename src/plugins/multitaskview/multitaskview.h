@@ -97,6 +97,9 @@ class MultitaskviewSurfaceModel : public QAbstractListModel
         int pendingDownIndex;
         int pendingLeftIndex;
         int pendingRightIndex;
+        // Circular neighbours with the same app id, in model order.
+        int prevSameAppIndex{ 0 };
+        int nextSameAppIndex{ 0 };
 
         void commit()
         {
@@ -169,9 +172,21 @@ Q_SIGNALS:
     void countChanged();
 
 private:
+    void packRows(const QList<ModelDataPtr> &rawData,
+                  int from,
+                  qreal rowH,
+                  QList<QList<ModelDataPtr>> &rows);
     bool tryLayout(const QList<ModelDataPtr> &rawData, qreal rowH, bool ignoreOverlap = false);
-    void calcDisplayPos(const QList<ModelDataPtr> &rawData);
+    // Re-pack from the row holding rawData[from] with current row height, false if a full
+    // layout is needed.
+    bool tryRelayout(const QList<ModelDataPtr> &rawData, int from);
+    void calcDisplayPos(const QList<ModelDataPtr> &rawData, int fromRow = 0);
     void doCalculateLayout(const QList<ModelDataPtr> &rawData);
+    void relayout(const QList<ModelDataPtr> &rawData, int from);
+    void scheduleRelayout(int from);
+    int takePendingRelayout(int from);
+    void processPendingRelayout();
+    void commitLayout();
     void doUpdateZOrder(const QList<ModelDataPtr> &rawData);
     std::pair<int, int> commitAndGetUpdateRange(const QList<ModelDataPtr> &rawData);
     void handleWrapperGeometryChanged();
@@ -182,6 +197,9 @@ private:
     void handleSurfaceRemoved(SurfaceWrapper *surface);
     void addReadySurface(SurfaceWrapper *surface);
     void monitorUnreadySurface(SurfaceWrapper *surface);
+    void monitorSurfaceGeometry(SurfaceWrapper *surface);
+    void updateSurfaceIndexes();
+    int indexOfSurface(SurfaceWrapper *surface) const;
     bool surfaceReady(SurfaceWrapper *surface);
     QRectF surfaceGeometry(SurfaceWrapper *surface);
     bool laterActiveThan(SurfaceWrapper *a, SurfaceWrapper *b);
@@ -189,10 +207,13 @@ private:
     void disconnectWorkspace(WorkspaceModel *workspace);
 
     QList<ModelDataPtr> m_data{};
+    // Row of each wrapper in m_data, rebuilt with same app neighbours on changes.
+    QHash<SurfaceWrapper *, int> m_surfaceIndexes{};
     QRectF m_layoutArea{};
     QList<QList<ModelDataPtr>> m_rows{};
     qreal m_rowHeight{ 0 };
     qreal m_contentHeight{ 0 };
+    int m_pendingRelayoutFrom{ -1 };
     bool m_modelReady;
     QList<ModelDataPtr> m_toBeInserted;
     WorkspaceModel *m_workspace = nullptr;
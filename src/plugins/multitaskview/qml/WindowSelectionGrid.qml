@@ -262,6 +262,8 @@ Item {
                         surface: surfaceItemDelegate.wrapper
                         live: true
                         fullProxy: true
+                        // Only the cell under pointer or focus follows client frames
+                        thumbnail: !surfaceItemDelegate.hovered && !surfaceItemDelegate.activeFocus
                         radius: delegateCornerRadius
                         width: parent.width
                         height: width / surfaceItemDelegate.ratio
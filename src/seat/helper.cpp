@@ -8,6 +8,7 @@
 #include "modules/dde-shell/ddeshellattached.h"
 #include "modules/dde-shell/ddeshellmanagerinterfacev1.h"
 #include "input/inputdevice.h"
+#include "seat/inputlatencytracker.h"
 #include "core/layersurfacecontainer.h"
 #include "greeter/usermodel.h"
 
@@ -88,12 +89,16 @@
 #include <QMouseEvent>
 #include <QQmlContext>
 #include <QQuickWindow>
+#include <QTimer>
+#include <QTouchEvent>
 #include <QtConcurrent>
 
 #include <pwd.h>
 #include <utility>
 
 #define WLR_FRACTIONAL_SCALE_V1_VERSION 1
+// Idle timeouts are in the order of seconds, reporting activity more often than this is wasted.
+static constexpr int IdleActivityInterval = 100;
 #define _DEEPIN_NO_TITLEBAR "_DEEPIN_NO_TITLEBAR"
 
 static xcb_atom_t internAtom(xcb_connection_t *connection, const char *name, bool onlyIfExists)
@@ -223,6 +228,11 @@ Helper::Helper(QObject *parent)
             &TreelandConfig::cursorSizeChanged,
             this,
             &Helper::cursorSizeChanged);
+
+    m_keyBindings.compile(TreelandConfig::ref().keyBindings());
+    connect(&TreelandConfig::ref(), &TreelandConfig::keyBindingsChanged, this, [this] {
+        m_keyBindings.compile(TreelandConfig::ref().keyBindings());
+    });
 }
 
 Helper::~Helper()
@@ -301,6 +311,11 @@ ShellHandler *Helper::shellHandler() const
     return m_shellHandler;
 }
 
+InputLatencyTracker *Helper::inputLatencyTracker() const
+{
+    return m_inputLatency;
+}
+
 Workspace *Helper::workspace() const
 {
     return m_shellHandler->workspace();
@@ -319,6 +334,8 @@ void Helper::onOutputAdded(WOutput *output)
     m_outputList.append(o);
     o->enable();
     m_outputManager->newOutput(output);
+    if (m_inputLatency)
+        m_inputLatency->addOutput(output);
 
     m_wallpaperColorV1->updateWallpaperColor(output->name(),
                                              m_personalization->backgroundIsDark(output->name()));
@@ -361,6 +378,8 @@ void Helper::onOutputRemoved(WOutput *output)
     auto index = indexOfOutput(output);
     Q_ASSERT(index >= 0);
     const auto o = m_outputList.takeAt(index);
+    if (m_inputLatency)
+        m_inputLatency->removeOutput(output);
 
     const auto &surfaces = getWorkspaceSurfaces(o);
     if (m_mode == OutputMode::Extension) {
@@ -828,6 +847,15 @@ void Helper::init()
                 m_multiTaskViewGesture->addTouchpadSwipeGesture(SwipeGesture::Up, 4);
                 m_multiTaskViewGesture->addTouchpadSwipeGesture(SwipeGesture::Right, 4);
             }
+        } else if (InputDevice::instance()->initTouchScreen(device)
+                   && !m_touchscreenGesturesAdded) {
+            // Touchscreens share one recognizer, register the gestures only once.
+            if (m_multiTaskViewGesture) {
+                m_multiTaskViewGesture->addTouchscreenEdgeSwipeGesture(SwipeGesture::Up);
+                m_multiTaskViewGesture->addTouchscreenSwipeGesture(SwipeGesture::Up, 3);
+                m_multiTaskViewGesture->addTouchscreenSwipeGesture(SwipeGesture::Right, 3);
+                m_touchscreenGesturesAdded = true;
+            }
         }
     });
 
@@ -836,6 +864,8 @@ void Helper::init()
     });
 
     m_outputManager = m_server->attach<WOutputManagerV1>();
+    if (InputLatencyTracker::isEnabled())
+        m_inputLatency = new InputLatencyTracker(this);
     connect(m_backend, &WBackend::outputAdded, this, &Helper::onOutputAdded);
     connect(m_backend, &WBackend::outputRemoved, this, &Helper::onOutputRemoved);
 
@@ -888,6 +918,13 @@ void Helper::init()
     m_shortcut = m_server->attach<ShortcutV1>();
     auto captureManagerV1 = m_server->attach<CaptureManagerV1>();
     captureManagerV1->setOutputRenderWindow(m_renderWindow);
+    captureManagerV1->setFrameRingSize(TreelandConfig::ref().captureFrameRingSize());
+    connect(&TreelandConfig::ref(),
+            &TreelandConfig::captureFrameRingSizeChanged,
+            captureManagerV1,
+            [captureManagerV1] {
+                captureManagerV1->setFrameRingSize(TreelandConfig::ref().captureFrameRingSize());
+            });
 
     connect(
         captureManagerV1,
@@ -1065,6 +1102,10 @@ void Helper::init()
 
 
     m_idleNotifier = qw_idle_notifier_v1::create(*m_server->handle());
+    m_idleActivityClock.start();
+    m_idleActivityTimer = new QTimer(this);
+    m_idleActivityTimer->setSingleShot(true);
+    connect(m_idleActivityTimer, &QTimer::timeout, this, &Helper::flushIdleActivity);
 
     m_idleInhibitManager = qw_idle_inhibit_manager_v1::create(*m_server->handle());
     connect(m_idleInhibitManager, &qw_idle_inhibit_manager_v1::notify_new_inhibitor, this, &Helper::onNewIdleInhibitor);
@@ -1157,10 +1198,125 @@ void Helper::fakePressSurfaceBottomRightToReszie(SurfaceWrapper *surface)
     Q_EMIT surface->requestResize(Qt::BottomEdge | Qt::RightEdge);
 }
 
+void Helper::notifyIdleActivity(WSeat *seat)
+{
+    // Report the first activity after a quiet period right away so idle clients resume
+    // without delay, and the last one of a burst when the interval expires so timeouts
+    // still count from the latest input.
+    const qint64 now = m_idleActivityClock.elapsed();
+    auto it = m_idleActivityTimes.find(seat);
+    if (it != m_idleActivityTimes.end() && now - *it < IdleActivityInterval) {
+        m_pendingIdleActivity.insert(seat);
+        if (!m_idleActivityTimer->isActive())
+            m_idleActivityTimer->start(IdleActivityInterval - (now - *it));
+        return;
+    }
+
+    m_idleActivityTimes.insert(seat, now);
+    m_idleNotifier->notify_activity(seat->nativeHandle());
+}
+
+void Helper::flushIdleActivity()
+{
+    const qint64 now = m_idleActivityClock.elapsed();
+    for (auto seat : std::as_const(m_pendingIdleActivity)) {
+        m_idleActivityTimes.insert(seat, now);
+        m_idleNotifier->notify_activity(seat->nativeHandle());
+    }
+    m_pendingIdleActivity.clear();
+}
+
+bool Helper::handleKeyBinding(KeyBindings::Action action)
+{
+    switch (action) {
+    case KeyBindings::LockScreenShutdown:
+        setCurrentMode(CurrentMode::LockScreen);
+        m_lockScreen->shutdown();
+        setWorkspaceVisible(false);
+        return true;
+    case KeyBindings::Quit:
+        qApp->quit();
+        return true;
+    case KeyBindings::SwitchToNextWorkspace:
+        restoreFromShowDesktop();
+        workspace()->switchToNext();
+        return true;
+    case KeyBindings::SwitchToPrevWorkspace:
+        restoreFromShowDesktop();
+        workspace()->switchToPrev();
+        return true;
+    case KeyBindings::SwitchToWorkspace1:
+    case KeyBindings::SwitchToWorkspace2:
+    case KeyBindings::SwitchToWorkspace3:
+    case KeyBindings::SwitchToWorkspace4:
+    case KeyBindings::SwitchToWorkspace5:
+    case KeyBindings::SwitchToWorkspace6:
+        restoreFromShowDesktop();
+        workspace()->switchTo(action - KeyBindings::SwitchToWorkspace1);
+        return true;
+    case KeyBindings::ToggleMultitaskView:
+        restoreFromShowDesktop();
+        if (m_multitaskView) {
+            m_multitaskView->toggleMultitaskView(IMultitaskView::ActiveReason::ShortcutKey);
+        }
+        return true;
+    case KeyBindings::LockScreen:
+#ifndef DISABLE_DDM
+        if (!m_lockScreen->isLocked())
+            showLockScreen();
+        return true;
+#else
+        return false;
+#endif
+    case KeyBindings::ToggleShowDesktop:
+        if (m_currentMode == CurrentMode::Multitaskview)
+            return true;
+        if (m_showDesktop == WindowManagementV1::DesktopState::Normal)
+            m_windowManagement->setDesktopState(WindowManagementV1::DesktopState::Show);
+        else if (m_showDesktop == WindowManagementV1::DesktopState::Show)
+            m_windowManagement->setDesktopState(WindowManagementV1::DesktopState::Normal);
+        return true;
+    case KeyBindings::MaximizeWindow:
+        if (!m_activatedSurface)
+            return false;
+        m_activatedSurface->requestMaximize();
+        return true;
+    case KeyBindings::CancelMaximizeWindow:
+        if (!m_activatedSurface)
+            return false;
+        m_activatedSurface->requestCancelMaximize();
+        return true;
+    case KeyBindings::CloseWindow:
+        if (!m_activatedSurface)
+            return false;
+        m_activatedSurface->requestClose();
+        return true;
+    case KeyBindings::ShowWindowMenu:
+        if (!m_activatedSurface)
+            return false;
+        Q_EMIT m_activatedSurface->requestShowWindowMenu({ 0, 0 });
+        return true;
+    case KeyBindings::TaskSwitchPrevious:
+        if (!m_taskSwitch)
+            return false;
+        QMetaObject::invokeMethod(m_taskSwitch, "previous");
+        return true;
+    case KeyBindings::TaskSwitchNext:
+        if (!m_taskSwitch)
+            return false;
+        QMetaObject::invokeMethod(m_taskSwitch, "next");
+        return true;
+    }
+
+    return false;
+}
+
 bool Helper::beforeDisposeEvent(WSeat *seat, QWindow *, QInputEvent *event)
 {
     if (event->isInputEvent()) {
-        m_idleNotifier->notify_activity(seat->nativeHandle());
+        notifyIdleActivity(seat);
+        if (m_inputLatency)
+            m_inputLatency->stampInput();
     }
     // NOTE: Unable to distinguish meta from other key combinations
     //       For example, Meta+S will still receive Meta release after
@@ -1181,70 +1337,16 @@ bool Helper::beforeDisposeEvent(WSeat *seat, QWindow *, QInputEvent *event)
 
     if (event->type() == QEvent::KeyPress) {
         auto kevent = static_cast<QKeyEvent *>(event);
-        if (m_currentMode == CurrentMode::Normal
-            && QKeySequence(kevent->modifiers() | kevent->key())
-                == QKeySequence(Qt::ControlModifier | Qt::AltModifier | Qt::Key_Delete)) {
-            setCurrentMode(CurrentMode::LockScreen);
-            m_lockScreen->shutdown();
-            setWorkspaceVisible(false);
+        const auto action =
+            m_keyBindings.find(static_cast<int>(m_currentMode), kevent->keyCombination());
+        if (action && (!m_captureSelector || KeyBindings::bypassesCaptureSelector(*action))
+            && handleKeyBinding(*action)) {
             return true;
         }
-        if (QKeySequence(kevent->modifiers() | kevent->key())
-            == QKeySequence(Qt::META | Qt::Key_F12)) {
-            qApp->quit();
-            return true;
-        } else if (m_captureSelector) {
+
+        if (m_captureSelector) {
             if (event->modifiers() == Qt::NoModifier && kevent->key() == Qt::Key_Escape)
                 m_captureSelector->cancelSelection();
-        } else if (event->modifiers() == Qt::MetaModifier) {
-            const QList<Qt::Key> switchWorkspaceNums = { Qt::Key_1, Qt::Key_2, Qt::Key_3,
-                                                         Qt::Key_4, Qt::Key_5, Qt::Key_6 };
-            if (kevent->key() == Qt::Key_Right) {
-                restoreFromShowDesktop();
-                workspace()->switchToNext();
-                return true;
-            } else if (kevent->key() == Qt::Key_Left) {
-                restoreFromShowDesktop();
-                workspace()->switchToPrev();
-                return true;
-            } else if (switchWorkspaceNums.contains(kevent->key())) {
-                restoreFromShowDesktop();
-                workspace()->switchTo(switchWorkspaceNums.indexOf(kevent->key()));
-                return true;
-            } else if (kevent->key() == Qt::Key_S
-                       && (m_currentMode == CurrentMode::Normal
-                           || m_currentMode == CurrentMode::Multitaskview)) {
-                restoreFromShowDesktop();
-                if (m_multitaskView) {
-                    m_multitaskView->toggleMultitaskView(IMultitaskView::ActiveReason::ShortcutKey);
-                }
-                return true;
-#ifndef DISABLE_DDM
-            } else if (kevent->key() == Qt::Key_L) {
-                if (m_lockScreen->isLocked()) {
-                    return true;
-                }
-
-                showLockScreen();
-                return true;
-#endif
-            } else if (kevent->key() == Qt::Key_D) { // ShowDesktop : Meta + D
-                if (m_currentMode == CurrentMode::Multitaskview) {
-                    return true;
-                }
-                if (m_showDesktop == WindowManagementV1::DesktopState::Normal)
-                    m_windowManagement->setDesktopState(WindowManagementV1::DesktopState::Show);
-                else if (m_showDesktop == WindowManagementV1::DesktopState::Show)
-                    m_windowManagement->setDesktopState(WindowManagementV1::DesktopState::Normal);
-                return true;
-            } else if (kevent->key() == Qt::Key_Up && m_activatedSurface) { // maximize: Meta + up
-                m_activatedSurface->requestMaximize();
-                return true;
-            } else if (kevent->key() == Qt::Key_Down
-                       && m_activatedSurface) { // cancelMaximize : Meta + down
-                m_activatedSurface->requestCancelMaximize();
-                return true;
-            }
         } else if (kevent->key() == Qt::Key_Alt) {
             m_taskAltTimestamp = kevent->timestamp();
             m_taskAltCount = 0;
@@ -1308,24 +1410,6 @@ bool Helper::beforeDisposeEvent(WSeat *seat, QWindow *, QInputEvent *event)
                     }
                 }
             }
-        } else if (event->modifiers() == Qt::AltModifier) {
-            if (kevent->key() == Qt::Key_F4 && m_activatedSurface) { // close window : Alt + F4
-                m_activatedSurface->requestClose();
-                return true;
-            }
-            if (kevent->key() == Qt::Key_Space && m_activatedSurface) {
-                Q_EMIT m_activatedSurface->requestShowWindowMenu({ 0, 0 });
-                return true;
-            }
-            if (m_taskSwitch) {
-                if (kevent->key() == Qt::Key_Left) {
-                    QMetaObject::invokeMethod(m_taskSwitch, "previous");
-                    return true;
-                } else if (kevent->key() == Qt::Key_Right) {
-                    QMetaObject::invokeMethod(m_taskSwitch, "next");
-                    return true;
-                }
-            }
         }
     }
 
@@ -1378,7 +1462,7 @@ bool Helper::beforeDisposeEvent(WSeat *seat, QWindow *, QInputEvent *event)
             return true;
         } else if (event->type() == QEvent::MouseButtonRelease
                    || event->type() == QEvent::TouchEnd) {
-            m_rootSurfaceContainer->endMoveResize();
+            m_rootSurfaceContainer->finishMoveResize();
             m_fakelastPressedPosition.reset();
         }
     }
@@ -1393,18 +1477,13 @@ bool Helper::beforeDisposeEvent(WSeat *seat, QWindow *, QInputEvent *event)
                 && !m_singleMetaKeyPendingPressed) {
                 break;
             }
-            bool isFind = false;
-            QKeySequence sequence(kevent->modifiers() | kevent->key());
             auto user = m_userModel->currentUser();
-            for (auto *action : m_shortcut->actions(user ? user->UID() : getuid())) {
-                if (action->shortcut() == sequence) {
-                    isFind = true;
-                    if (event->type() == QEvent::KeyRelease) {
-                        action->activate(QAction::Trigger);
-                    }
+            auto action = m_shortcut->findAction(user ? user->UID() : getuid(),
+                                                 kevent->keyCombination());
+            if (action) {
+                if (event->type() == QEvent::KeyRelease) {
+                    action->activate(QAction::Trigger);
                 }
-            }
-            if (isFind) {
                 return true;
             }
         } while (false);
@@ -1446,6 +1525,22 @@ bool Helper::unacceptedEvent(WSeat *, QWindow *, QInputEvent *event)
 
 bool Helper::doGesture(QInputEvent *event)
 {
+    if (event->type() == QEvent::TouchBegin || event->type() == QEvent::TouchUpdate
+        || event->type() == QEvent::TouchEnd || event->type() == QEvent::TouchCancel) {
+        auto e = static_cast<QTouchEvent *>(event);
+        QRectF outputGeometry;
+        if (event->type() == QEvent::TouchBegin && !e->points().isEmpty()) {
+            const QPointF pos = e->points().constFirst().globalPosition();
+            for (auto output : m_rootSurfaceContainer->outputs()) {
+                if (output->geometry().contains(pos)) {
+                    outputGeometry = output->geometry();
+                    break;
+                }
+            }
+        }
+        InputDevice::instance()->processTouchEvent(e, outputGeometry);
+    }
+
     if (event->type() == QEvent::NativeGesture) {
         auto e = static_cast<WGestureEvent *>(event);
         switch (e->gestureType()) {
@@ -1461,14 +1556,14 @@ bool Helper::doGesture(QInputEvent *event)
                 if (e->cancelled())
                     InputDevice::instance()->processSwipeCancel();
                 else
-                    InputDevice::instance()->processSwipeEnd();
+                    InputDevice::instance()->processSwipeEnd(e->timestamp());
             }
             if (e->libInputGestureType() == WGestureEvent::WLibInputGestureType::HoldGesture)
                 InputDevice::instance()->processHoldEnd();
             break;
         case Qt::PanNativeGesture:
             if (e->libInputGestureType() == WGestureEvent::WLibInputGestureType::SwipeGesture)
-                InputDevice::instance()->processSwipeUpdate(e->delta());
+                InputDevice::instance()->processSwipeUpdate(e->delta(), e->timestamp());
         case Qt::ZoomNativeGesture:
         case Qt::SmartZoomNativeGesture:
         case Qt::RotateNativeGesture:
@@ -5,6 +5,7 @@
 
 #include "modules/foreign-toplevel/foreigntoplevelmanagerv1.h"
 #include "core/qmlengine.h"
+#include "input/keybindings.h"
 #include "input/togglablegesture.h"
 #include "modules/virtual-output/virtualoutputmanager.h"
 #include "modules/window-management/windowmanagement.h"
@@ -14,6 +15,10 @@
 #include <wseat.h>
 #include <wxdgdecorationmanager.h>
 
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+
 Q_MOC_INCLUDE(<wtoplevelsurface.h>)
 Q_MOC_INCLUDE(<wxdgsurface.h>)
 Q_MOC_INCLUDE(<qwgammacontorlv1.h>)
@@ -28,6 +33,7 @@ Q_MOC_INCLUDE(<QDBusObjectPath>)
 QT_BEGIN_NAMESPACE
 class QQuickItem;
 class QDBusObjectPath;
+class QTimer;
 QT_END_NAMESPACE
 
 WAYLIB_SERVER_BEGIN_NAMESPACE
@@ -83,6 +89,7 @@ class VirtualOutputV1;
 class ShellHandler;
 class PrimaryOutputV1;
 class CaptureSourceSelector;
+class InputLatencyTracker;
 class treeland_window_picker_v1;
 class IMultitaskView;
 class LockScreenInterface;
@@ -196,6 +203,8 @@ public:
     void showLockScreen();
 
     Output* getOutputAtCursor() const;
+    // Only set when TREELAND_INPUT_LATENCY is set.
+    InputLatencyTracker *inputLatencyTracker() const;
 public Q_SLOTS:
     void activateSurface(SurfaceWrapper *wrapper, Qt::FocusReason reason = Qt::OtherFocusReason);
     void forceActivateSurface(SurfaceWrapper *wrapper,
@@ -267,10 +276,14 @@ private:
                           QObject *,
                           QInputEvent *event) override;
     bool unacceptedEvent(WSeat *, QWindow *, QInputEvent *event) override;
+    // Returns false if the action does not apply right now, e.g. without an activated surface.
+    bool handleKeyBinding(KeyBindings::Action action);
 
     void handleLeftButtonStateChanged(const QInputEvent *event);
     void handleWhellValueChanged(const QInputEvent *event);
     bool doGesture(QInputEvent *event);
+    void notifyIdleActivity(WSeat *seat);
+    void flushIdleActivity();
     Output *createNormalOutput(WOutput *output);
     Output *createCopyOutput(WOutput *output, Output *proxy);
     QList<SurfaceWrapper *> getWorkspaceSurfaces(Output *filterOutput = nullptr);
@@ -305,6 +318,11 @@ private:
     // protocols
     qw_compositor *m_compositor = nullptr;
     qw_idle_notifier_v1 *m_idleNotifier = nullptr;
+    // Last time activity was reported per seat, on m_idleActivityClock.
+    QHash<WSeat *, qint64> m_idleActivityTimes;
+    QSet<WSeat *> m_pendingIdleActivity;
+    QElapsedTimer m_idleActivityClock;
+    QTimer *m_idleActivityTimer = nullptr;
     qw_idle_inhibit_manager_v1 *m_idleInhibitManager = nullptr;
     qw_output_power_manager_v1 *m_outputPowerManager = nullptr;
     ShellHandler *m_shellHandler = nullptr;
@@ -337,11 +355,14 @@ private:
     std::optional<QPointF> m_fakelastPressedPosition;
 
     QPointer<CaptureSourceSelector> m_captureSelector;
+    InputLatencyTracker *m_inputLatency{ nullptr };
+    KeyBindings m_keyBindings;
 
     QPropertyAnimation *m_workspaceScaleAnimation{ nullptr };
     QPropertyAnimation *m_workspaceOpacityAnimation{ nullptr };
 
     bool m_singleMetaKeyPendingPressed{ false };
+    bool m_touchscreenGesturesAdded{ false };
 
     IMultitaskView *m_multitaskView{ nullptr };
     UserModel *m_userModel{ nullptr };
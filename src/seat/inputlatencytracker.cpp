@@ -0,0 +1,165 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "inputlatencytracker.h"
+
+#include <woutput.h>
+
+#include <qwoutput.h>
+
+#include <QTextStream>
+
+#include <algorithm>
+#include <utility>
+
+#include <time.h>
+
+QW_USE_NAMESPACE
+
+// Latest samples kept per output for the percentiles.
+static constexpr qsizetype MaxSamples = 4096;
+// Frames in flight are bounded by the backend, more means presentation is not reported.
+static constexpr qsizetype MaxCommittedFrames = 8;
+// Input that did not lead to a frame for this long most likely changed nothing on the output.
+static constexpr qint64 MaxPendingInputAge = 500 * 1000 * 1000;
+
+static qint64 monotonicNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// commit_seq wraps around, compare by distance.
+static inline bool commitSeqBefore(uint32_t a, uint32_t b)
+{
+    return qint32(a - b) < 0;
+}
+
+static double percentileMs(const QList<qint64> &sorted, double percentile)
+{
+    if (sorted.isEmpty())
+        return 0;
+    const auto index = qMin<qsizetype>(sorted.size() * percentile, sorted.size() - 1);
+    return sorted.at(index) / 1e6;
+}
+
+InputLatencyTracker::InputLatencyTracker(QObject *parent)
+    : QObject(parent)
+{
+}
+
+bool InputLatencyTracker::isEnabled()
+{
+    return qEnvironmentVariableIsSet("TREELAND_INPUT_LATENCY");
+}
+
+void InputLatencyTracker::addOutput(WOutput *output)
+{
+    m_outputs.insert(output, {});
+
+    // Presentation time is reported on the CLOCK_MONOTONIC timeline, like monotonicNs().
+    connect(output->handle(),
+            &qw_output::notify_commit,
+            this,
+            [this, output](wlr_output_event_commit *event) {
+                // commit_seq is already advanced to this commit when the event is emitted.
+                if (event->state->committed & WLR_OUTPUT_STATE_BUFFER)
+                    handleCommit(output, event->output->commit_seq);
+            });
+    connect(output->handle(),
+            &qw_output::notify_present,
+            this,
+            [this, output](wlr_output_event_present *event) {
+                const qint64 presentTime = event->presented && event->when
+                    ? qint64(event->when->tv_sec) * 1000000000 + event->when->tv_nsec
+                    : 0;
+                handlePresent(output, event->commit_seq, presentTime);
+            });
+}
+
+void InputLatencyTracker::removeOutput(WOutput *output)
+{
+    output->handle()->disconnect(this);
+    m_outputs.remove(output);
+}
+
+void InputLatencyTracker::stampInput()
+{
+    const qint64 now = monotonicNs();
+    for (auto &latency : m_outputs) {
+        if (!latency.pendingInput)
+            latency.pendingInput = now;
+    }
+}
+
+void InputLatencyTracker::reset()
+{
+    for (auto &latency : m_outputs) {
+        latency.samples.clear();
+        latency.nextSample = 0;
+    }
+}
+
+void InputLatencyTracker::handleCommit(WOutput *output, uint32_t commitSeq)
+{
+    auto &latency = m_outputs[output];
+    qint64 inputTime = std::exchange(latency.pendingInput, 0);
+    if (inputTime && monotonicNs() - inputTime > MaxPendingInputAge)
+        inputTime = 0;
+
+    latency.committed.append({ commitSeq, inputTime });
+    // Frames are matched by commit_seq, dropping the oldest doesn't shift the others.
+    if (latency.committed.size() > MaxCommittedFrames)
+        latency.committed.removeFirst();
+}
+
+void InputLatencyTracker::handlePresent(WOutput *output, uint32_t commitSeq, qint64 presentTime)
+{
+    // Present events come in commit order, frames committed before this one that are
+    // still waiting will never be presented.
+    auto &latency = m_outputs[output];
+    while (!latency.committed.isEmpty()
+           && commitSeqBefore(latency.committed.first().commitSeq, commitSeq)) {
+        latency.committed.removeFirst();
+    }
+    // Not a frame we recorded, e.g. a commit without a new buffer.
+    if (latency.committed.isEmpty() || latency.committed.first().commitSeq != commitSeq)
+        return;
+
+    const qint64 inputTime = latency.committed.takeFirst().inputTime;
+    if (!inputTime || !presentTime || presentTime < inputTime)
+        return;
+
+    if (latency.samples.size() < MaxSamples) {
+        latency.samples.append(presentTime - inputTime);
+    } else {
+        latency.samples[latency.nextSample] = presentTime - inputTime;
+        latency.nextSample = (latency.nextSample + 1) % MaxSamples;
+    }
+}
+
+QString InputLatencyTracker::report() const
+{
+    QString text;
+    QTextStream out(&text);
+    out << QStringLiteral("%1 %2 %3 %4 %5 %6\n")
+               .arg("output", -12)
+               .arg("samples", 8)
+               .arg("p50(ms)", 8)
+               .arg("p95(ms)", 8)
+               .arg("p99(ms)", 8)
+               .arg("max(ms)", 8);
+    for (auto it = m_outputs.cbegin(); it != m_outputs.cend(); ++it) {
+        auto samples = it->samples;
+        std::sort(samples.begin(), samples.end());
+        out << QStringLiteral("%1 %2 %3 %4 %5 %6\n")
+                   .arg(it.key()->name(), -12)
+                   .arg(samples.size(), 8)
+                   .arg(percentileMs(samples, 0.50), 8, 'f', 2)
+                   .arg(percentileMs(samples, 0.95), 8, 'f', 2)
+                   .arg(percentileMs(samples, 0.99), 8, 'f', 2)
+                   .arg(samples.isEmpty() ? 0 : samples.last() / 1e6, 8, 'f', 2);
+    }
+    return text;
+}
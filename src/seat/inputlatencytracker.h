@@ -0,0 +1,61 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+#pragma once
+
+#include <wglobal.h>
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+class WOutput;
+WAYLIB_SERVER_END_NAMESPACE
+
+WAYLIB_SERVER_USE_NAMESPACE
+
+// Measures the time from an input event reaching the compositor until the first frame
+// committed after it is presented, per output. Enabled by TREELAND_INPUT_LATENCY.
+class InputLatencyTracker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit InputLatencyTracker(QObject *parent = nullptr);
+
+    static bool isEnabled();
+
+    void addOutput(WOutput *output);
+    void removeOutput(WOutput *output);
+
+    void stampInput();
+    void reset();
+    // Sample count and p50/p95/p99/max of every output, in milliseconds.
+    QString report() const;
+
+private:
+    struct CommittedFrame
+    {
+        // wlr_output::commit_seq of the commit, matched by the present event.
+        uint32_t commitSeq{ 0 };
+        // Input time carried by the frame, 0 if none.
+        qint64 inputTime{ 0 };
+    };
+
+    struct OutputLatency
+    {
+        // Earliest input not yet carried by a committed frame, 0 if none.
+        qint64 pendingInput{ 0 };
+        // Committed frames awaiting presentation, in commit order.
+        QList<CommittedFrame> committed;
+        // Ring buffer of the latest latencies, in nanoseconds.
+        QList<qint64> samples;
+        qsizetype nextSample{ 0 };
+    };
+
+    void handleCommit(WOutput *output, uint32_t commitSeq);
+    // presentTime is 0 if the frame was discarded.
+    void handlePresent(WOutput *output, uint32_t commitSeq, qint64 presentTime);
+
+    QHash<WOutput *, OutputLatency> m_outputs;
+};
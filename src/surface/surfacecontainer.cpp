@@ -29,7 +29,7 @@ QMap<int, QVariant> SurfaceListModel::itemData(const QModelIndex &index) const
 
     auto surface = surfaces().at(index.row());
     auto container = surface->container();
-    const auto orderIndex = container->childItems().indexOf(surface);
+    const auto orderIndex = container->stackingIndex(surface);
     Q_ASSERT(orderIndex >= 0);
     datas.insert(Qt::InitialSortOrderRole, orderIndex);
 
@@ -44,7 +44,7 @@ QVariant SurfaceListModel::data(const QModelIndex &index, int role) const
     if (role == Qt::InitialSortOrderRole) {
         auto surface = surfaces().at(index.row());
         auto container = surface->container();
-        const auto orderIndex = container->childItems().indexOf(surface);
+        const auto orderIndex = container->stackingIndex(surface);
         Q_ASSERT(orderIndex >= 0);
         return orderIndex;
     }
@@ -216,6 +216,31 @@ void SurfaceContainer::geometryChange(const QRectF &newGeo, const QRectF &oldGeo
     QQuickItem::geometryChange(newGeo, oldGeo);
 }
 
+void SurfaceContainer::itemChange(ItemChange change, const ItemChangeData &data)
+{
+    if (change == ItemChildAddedChange || change == ItemChildRemovedChange)
+        invalidateStackingIndex();
+
+    QQuickItem::itemChange(change, data);
+}
+
+int SurfaceContainer::stackingIndex(QQuickItem *item) const
+{
+    if (m_stackingIndex.isEmpty()) {
+        const auto children = childItems();
+        m_stackingIndex.reserve(children.size());
+        for (int i = 0; i < children.size(); ++i)
+            m_stackingIndex.insert(children.at(i), i);
+    }
+
+    return m_stackingIndex.value(item, -1);
+}
+
+void SurfaceContainer::invalidateStackingIndex()
+{
+    m_stackingIndex.clear();
+}
+
 bool SurfaceContainer::doAddSurface(SurfaceWrapper *surface, bool setContainer)
 {
     if (m_model->hasSurface(surface))
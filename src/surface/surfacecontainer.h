@@ -228,6 +228,9 @@ public:
         return m_model;
     }
 
+    // Index of item in childItems(), cached until the children or their order change.
+    int stackingIndex(QQuickItem *item) const;
+
 Q_SIGNALS:
     void surfaceAdded(SurfaceWrapper *surface);
     void surfaceRemoved(SurfaceWrapper *surface);
@@ -237,6 +240,8 @@ protected:
 
     void ensureQmlContext();
     void geometryChange(const QRectF &newGeo, const QRectF &oldGeo) override;
+    void itemChange(ItemChange change, const ItemChangeData &data) override;
+    void invalidateStackingIndex();
 
     bool doAddSurface(SurfaceWrapper *surface, bool setContainer);
     bool doRemoveSurface(SurfaceWrapper *surface, bool setContainer);
@@ -253,6 +258,9 @@ protected:
                                           SurfaceWrapper::State oldState);
 
     SurfaceListModel *m_model = nullptr;
+
+private:
+    mutable QHash<QQuickItem *, int> m_stackingIndex;
 };
 
 Q_DECLARE_OPAQUE_POINTER(Output*)
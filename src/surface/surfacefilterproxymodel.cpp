@@ -12,8 +12,11 @@ SurfaceFilterProxyModel::SurfaceFilterProxyModel(QObject *parent)
 
 void SurfaceFilterProxyModel::setFilterAppId(const QString &appid)
 {
+    if (m_filterAppId == appid)
+        return;
     m_filterAppId = appid;
-    invalidateFilter();
+    // Only rows depend on the app id.
+    invalidateRowsFilter();
 }
 
 int SurfaceFilterProxyModel::activeIndex()
@@ -32,15 +35,15 @@ void SurfaceFilterProxyModel::setActiveIndex(int index)
 bool SurfaceFilterProxyModel::filterAcceptsRow(int source_row,
                                                const QModelIndex &source_parent) const
 {
+    if (m_filterAppId.isEmpty()) {
+        return true;
+    }
+
     QModelIndex index = sourceModel()->index(source_row, 0, source_parent);
     SurfaceWrapper *surface = sourceModel()->data(index).value<SurfaceWrapper *>();
     auto wsurface = surface->shellSurface();
     Q_ASSERT(wsurface);
 
-    if (m_filterAppId.isEmpty()) {
-        return true;
-    }
-
     if (surface) {
         return wsurface->appId() == m_filterAppId;
     }
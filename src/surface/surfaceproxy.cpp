@@ -6,7 +6,19 @@
 #include "core/qmlengine.h"
 #include "surface/surfacewrapper.h"
 
+#include <wsurface.h>
+
+#include <qwcompositor.h>
+
+#include <QTimer>
+
 #include <private/qquickitem_p.h>
+#include <private/qquickshadereffectsource_p.h>
+
+QW_USE_NAMESPACE
+
+// Upper bound of thumbnail refreshes, a thumbnail doesn't need to follow every frame.
+static constexpr int ThumbnailRefreshInterval = 100;
 
 SurfaceProxy::SurfaceProxy(QQuickItem *parent)
     : QQuickItem(parent)
@@ -29,6 +41,11 @@ void SurfaceProxy::setSurface(SurfaceWrapper *newSurface)
     m_sourceConnections.clear();
 
     m_sourceSurface = newSurface;
+    if (m_thumbnail) {
+        QObject::disconnect(m_thumbnailConnection);
+        m_thumbnail->deleteLater();
+        m_thumbnail = nullptr;
+    }
     if (m_proxySurface) {
         m_proxySurface->deleteLater();
         m_proxySurface = nullptr;
@@ -102,6 +119,7 @@ void SurfaceProxy::setSurface(SurfaceWrapper *newSurface)
         updateImplicitSize();
         updateProxySurfaceScale();
         updateProxySurfaceTitleBarAndDecoration();
+        updateThumbnail();
     } else {
         if (m_shadow) {
             m_shadow->deleteLater();
@@ -138,6 +156,7 @@ void SurfaceProxy::updateProxySurfaceScale()
         m_proxySurface->setScale(1.0);
         m_proxySurface->setRadius(radius());
     }
+    updateThumbnailGeometry();
 }
 
 void SurfaceProxy::updateProxySurfaceTitleBarAndDecoration()
@@ -167,6 +186,7 @@ void SurfaceProxy::updateImplicitSize()
     const auto scaledSize = size.scaled(m_maxSize, Qt::KeepAspectRatio);
     const auto scale = scaledSize.width() / size.width();
     setImplicitSize(size.width() * scale, size.height() * scale);
+    updateThumbnailGeometry();
 }
 
 void SurfaceProxy::onSourceRadiusChanged()
@@ -269,3 +289,78 @@ void SurfaceProxy::setFullProxy(bool newFullProxy)
 
     Q_EMIT fullProxyChanged();
 }
+
+bool SurfaceProxy::thumbnail() const
+{
+    return m_thumbnailEnabled;
+}
+
+void SurfaceProxy::setThumbnail(bool newThumbnail)
+{
+    if (m_thumbnailEnabled == newThumbnail)
+        return;
+    m_thumbnailEnabled = newThumbnail;
+    updateThumbnail();
+
+    Q_EMIT thumbnailChanged();
+}
+
+void SurfaceProxy::updateThumbnail()
+{
+    const bool enabled = m_thumbnailEnabled && m_proxySurface;
+    if (enabled == bool(m_thumbnail))
+        return;
+    if (!enabled) {
+        QObject::disconnect(m_thumbnailConnection);
+        m_thumbnail->deleteLater();
+        m_thumbnail = nullptr;
+        return;
+    }
+    if (!m_thumbnailTimer) {
+        m_thumbnailTimer = new QTimer(this);
+        m_thumbnailTimer->setSingleShot(true);
+        m_thumbnailTimer->setInterval(ThumbnailRefreshInterval);
+        connect(m_thumbnailTimer, &QTimer::timeout, this, [this] {
+            if (m_thumbnailDirty)
+                scheduleThumbnailUpdate();
+        });
+    }
+    m_thumbnail = new QQuickShaderEffectSource(this);
+    m_thumbnail->setSourceItem(m_proxySurface);
+    m_thumbnail->setHideSource(true);
+    m_thumbnail->setLive(false);
+    m_thumbnail->setSmooth(true);
+    m_thumbnail->stackAfter(m_proxySurface);
+    if (auto surface = m_sourceSurface->surface()) {
+        m_thumbnailConnection = connect(surface->handle(),
+                                        &qw_surface::notify_commit,
+                                        this,
+                                        &SurfaceProxy::scheduleThumbnailUpdate);
+    }
+    updateThumbnailGeometry();
+}
+
+void SurfaceProxy::updateThumbnailGeometry()
+{
+    if (!m_thumbnail)
+        return;
+    // Proxy surface is scaled from its top left, the thumbnail covers what it shows.
+    const QSizeF size = m_proxySurface->size() * m_proxySurface->scale();
+    const qreal devicePixelRatio = window() ? window()->effectiveDevicePixelRatio() : 1.0;
+    m_thumbnail->setSize(size);
+    m_thumbnail->setTextureSize((size * devicePixelRatio).toSize());
+    scheduleThumbnailUpdate();
+}
+
+void SurfaceProxy::scheduleThumbnailUpdate()
+{
+    if (!m_thumbnail)
+        return;
+    if (m_thumbnailTimer->isActive()) {
+        m_thumbnailDirty = true;
+        return;
+    }
+    m_thumbnailDirty = false;
+    m_thumbnail->scheduleUpdate();
+    m_thumbnailTimer->start();
+}
@@ -5,6 +5,8 @@
 
 #include <QQuickItem>
 
+class QQuickShaderEffectSource;
+class QTimer;
 class SurfaceWrapper;
 
 class SurfaceProxy : public QQuickItem
@@ -15,6 +17,7 @@ class SurfaceProxy : public QQuickItem
     Q_PROPERTY(bool live READ live WRITE setLive NOTIFY liveChanged FINAL)
     Q_PROPERTY(QSizeF maxSize READ maxSize WRITE setMaxSize NOTIFY maxSizeChanged FINAL)
     Q_PROPERTY(bool fullProxy READ fullProxy WRITE setFullProxy NOTIFY fullProxyChanged FINAL)
+    Q_PROPERTY(bool thumbnail READ thumbnail WRITE setThumbnail NOTIFY thumbnailChanged FINAL)
     QML_ELEMENT
 
 public:
@@ -36,12 +39,18 @@ public:
     bool fullProxy() const;
     void setFullProxy(bool newFullProxy);
 
+    // Show a texture downscaled to the proxy size, refreshed on commits at a bounded rate,
+    // instead of sampling the full size client buffer every frame.
+    bool thumbnail() const;
+    void setThumbnail(bool newThumbnail);
+
 Q_SIGNALS:
     void surfaceChanged();
     void radiusChanged();
     void liveChanged();
     void maxSizeChanged();
     void fullProxyChanged();
+    void thumbnailChanged();
 
 private:
     void geometryChange(const QRectF &newGeo, const QRectF &oldGeo) override;
@@ -49,6 +58,9 @@ private:
     void updateProxySurfaceTitleBarAndDecoration();
     void updateImplicitSize();
     void onSourceRadiusChanged();
+    void updateThumbnail();
+    void updateThumbnailGeometry();
+    void scheduleThumbnailUpdate();
 
     SurfaceWrapper *m_sourceSurface = nullptr;
     SurfaceWrapper *m_proxySurface = nullptr;
@@ -58,4 +70,9 @@ private:
     bool m_live = true;
     bool m_fullProxy = false;
     QSizeF m_maxSize;
+    bool m_thumbnailEnabled = false;
+    bool m_thumbnailDirty = false;
+    QQuickShaderEffectSource *m_thumbnail = nullptr;
+    QTimer *m_thumbnailTimer = nullptr;
+    QMetaObject::Connection m_thumbnailConnection;
 };
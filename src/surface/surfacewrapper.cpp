@@ -6,6 +6,7 @@
 #include "config/treelandconfig.h"
 #include "core/qmlengine.h"
 #include "output/output.h"
+#include "surface/surfacecontainer.h"
 #include "workspace/workspace.h"
 
 #include <winputpopupsurfaceitem.h>
@@ -1219,6 +1220,8 @@ bool SurfaceWrapper::stackBefore(QQuickItem *item)
         }
     } while (false);
 
+    if (auto container = qobject_cast<SurfaceContainer *>(parentItem()))
+        container->invalidateStackingIndex();
     updateSubSurfaceStacking();
     return true;
 }
@@ -1264,6 +1267,8 @@ bool SurfaceWrapper::stackAfter(QQuickItem *item)
         }
     } while (false);
 
+    if (auto container = qobject_cast<SurfaceContainer *>(parentItem()))
+        container->invalidateStackingIndex();
     updateSubSurfaceStacking();
     return true;
 }
@@ -4,6 +4,7 @@
 
 #include "config/treelandconfig.h"
 
+#include <algorithm>
 #include <cmath>
 
 WorkspaceAnimationController::WorkspaceAnimationController(QObject *parent)
@@ -177,8 +178,20 @@ void WorkspaceAnimationController::startGestureSlide(qreal cb, bool bounce)
     setViewportPos(pos);
 }
 
-void WorkspaceAnimationController::startSlideAnimation()
+void WorkspaceAnimationController::startSlideAnimation(qreal velocity)
 {
+    const int duration = TreelandConfig::ref().multitaskviewAnimationDuration();
+    const qreal distance = m_animationDestination - m_animationInitial;
+    const qreal speed = velocity * refWrap() / 1000.0;
+    if (distance * speed > 0) {
+        // Continue at the speed of the gesture, OutCubic starts at three times its average speed.
+        const int flingDuration = int(3 * std::abs(distance / speed));
+        m_posAnimation->setEasingCurve(QEasingCurve::OutCubic);
+        m_posAnimation->setDuration(std::clamp(flingDuration, duration / 4, duration));
+    } else {
+        m_posAnimation->setEasingCurve(TreelandConfig::ref().multitaskviewEasingCurveType());
+        m_posAnimation->setDuration(duration);
+    }
     m_posAnimation->setStartValue(m_animationInitial);
     m_posAnimation->setEndValue(m_animationDestination);
     m_slideAnimation->start();
@@ -59,7 +59,8 @@ public Q_SLOTS:
     void slide(uint fromWorkspaceIndex, uint toWorkspaceIndex);
     void bounce(uint currentWorkspaceIndex, Direction direction);
     void setRunning(bool running);
-    void startSlideAnimation();
+    // velocity is in workspaces per second, positive towards the next workspace.
+    void startSlideAnimation(qreal velocity = 0);
     void startGestureSlide(qreal cb, bool bounce = false);
 
 private:
@@ -0,0 +1,505 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "capturebenchmark.h"
+
+#include <QFile>
+#include <QGuiApplication>
+#include <QMetaEnum>
+#include <QPainter>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <algorithm>
+
+#include <wayland-client-core.h>
+
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+// Matches source_failure.selector_busy of treeland_capture_context_v1.
+static constexpr uint32_t SelectorBusy = 1;
+static constexpr int SelectRetryInterval = 100;
+
+static qint64 realtimeUs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return qint64(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+static qint64 timevalUs(const timeval &tv)
+{
+    return qint64(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
+static qint64 selfCpuUs()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return timevalUs(usage.ru_utime) + timevalUs(usage.ru_stime);
+}
+
+static qint64 processCpuUs(pid_t pid)
+{
+    QFile stat(QStringLiteral("/proc/%1/stat").arg(pid));
+    if (!stat.open(QIODevice::ReadOnly))
+        return -1;
+    // Fields after the command name, which may contain spaces, utime and stime are 14 and 15.
+    const QByteArray content = stat.readAll();
+    const auto fields = content.mid(content.lastIndexOf(')') + 2).split(' ');
+    if (fields.size() < 13)
+        return -1;
+    const qint64 ticks = fields.at(11).toLongLong() + fields.at(12).toLongLong();
+    return ticks * 1000000 / sysconf(_SC_CLK_TCK);
+}
+
+static pid_t compositorPid()
+{
+    auto waylandApp = qGuiApp->nativeInterface<QNativeInterface::QWaylandApplication>();
+    if (!waylandApp || !waylandApp->display())
+        return 0;
+    ucred cred;
+    socklen_t len = sizeof(cred);
+    const int fd = wl_display_get_fd(waylandApp->display());
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len))
+        return 0;
+    return cred.pid;
+}
+
+static double percentileMs(QList<qint64> sorted, double percentile)
+{
+    if (sorted.isEmpty())
+        return 0;
+    const auto index = qMin<qsizetype>(sorted.size() * percentile, sorted.size() - 1);
+    return sorted.at(index) / 1000.0;
+}
+
+CaptureBenchmarkManager::CaptureBenchmarkManager()
+    : QWaylandClientExtensionTemplate<CaptureBenchmarkManager>(1)
+    , QtWayland::treeland_capture_manager_v1()
+{
+}
+
+CaptureBenchmarkExtensionManager::CaptureBenchmarkExtensionManager()
+    : QWaylandClientExtensionTemplate<CaptureBenchmarkExtensionManager>(1)
+    , QtWayland::treeland_capture_session_extension_manager_v1()
+{
+}
+
+CaptureBenchmarkShm::CaptureBenchmarkShm()
+    : QWaylandClientExtensionTemplate<CaptureBenchmarkShm>(1)
+    , QtWayland::wl_shm()
+{
+}
+
+class CaptureStreamSession : public QtWayland::treeland_capture_session_v1
+{
+public:
+    CaptureStreamSession(::treeland_capture_session_v1 *object, CaptureStream *stream)
+        : QtWayland::treeland_capture_session_v1(object)
+        , m_stream(stream)
+    {
+    }
+
+    ~CaptureStreamSession() override
+    {
+        if (m_extension)
+            m_extension->destroy();
+        destroy();
+    }
+
+    // Must be called before start, see treeland_capture_session_extension_manager_v1.
+    void setMaxFrameRate(CaptureBenchmarkExtensionManager *extensionManager, uint32_t fps)
+    {
+        m_extension = std::make_unique<QtWayland::treeland_capture_session_extension_v1>(
+            extensionManager->get_extension(object()));
+        m_extension->set_max_frame_rate(fps);
+    }
+
+protected:
+    void treeland_capture_session_v1_object(uint32_t,
+                                            int32_t fd,
+                                            uint32_t,
+                                            uint32_t,
+                                            uint32_t,
+                                            uint32_t) override
+    {
+        // Buffer content is not consumed, only the delivery is measured.
+        close(fd);
+    }
+
+    void treeland_capture_session_v1_ready(uint32_t tv_sec_hi,
+                                           uint32_t tv_sec_lo,
+                                           uint32_t tv_nsec) override
+    {
+        m_stream->handleReady(tv_sec_hi, tv_sec_lo, tv_nsec);
+        frame_done(tv_sec_hi, tv_sec_lo, tv_nsec);
+    }
+
+    void treeland_capture_session_v1_cancel(uint32_t) override
+    {
+        m_stream->handleCancel();
+    }
+
+private:
+    CaptureStream *m_stream;
+    std::unique_ptr<QtWayland::treeland_capture_session_extension_v1> m_extension;
+};
+
+class CaptureStreamFrame : public QtWayland::treeland_capture_frame_v1
+{
+public:
+    CaptureStreamFrame(::treeland_capture_frame_v1 *object, CaptureStream *stream)
+        : QtWayland::treeland_capture_frame_v1(object)
+        , m_stream(stream)
+    {
+    }
+
+    ~CaptureStreamFrame() override
+    {
+        destroy();
+    }
+
+protected:
+    void treeland_capture_frame_v1_buffer(uint32_t format,
+                                          uint32_t width,
+                                          uint32_t height,
+                                          uint32_t stride) override
+    {
+        m_buffer = m_stream->shmBuffer(format, width, height, stride);
+    }
+
+    void treeland_capture_frame_v1_buffer_done() override
+    {
+        if (!m_buffer) {
+            qCritical() << "Cannot allocate buffer for one-shot capture";
+            return;
+        }
+        copy(m_buffer);
+    }
+
+    void treeland_capture_frame_v1_ready() override
+    {
+        m_stream->handleCaptured();
+    }
+
+    void treeland_capture_frame_v1_failed() override
+    {
+        m_stream->handleCancel();
+        // Don't destroy the frame from its own event handler.
+        QMetaObject::invokeMethod(m_stream, &CaptureStream::captureNext, Qt::QueuedConnection);
+    }
+
+private:
+    CaptureStream *m_stream;
+    ::wl_buffer *m_buffer{ nullptr };
+};
+
+CaptureStream::CaptureStream(::treeland_capture_context_v1 *object, Source source, QObject *parent)
+    : QObject(parent)
+    , QtWayland::treeland_capture_context_v1(object)
+    , m_source(source)
+{
+}
+
+CaptureStream::~CaptureStream()
+{
+    m_frame.reset();
+    m_session.reset();
+    if (m_buffer)
+        m_buffer->destroy();
+    destroy();
+}
+
+void CaptureStream::select()
+{
+    uint32_t hint = source_type_output;
+    if (m_source == Window)
+        hint = source_type_window;
+    else if (m_source == Region)
+        hint = source_type_region;
+    select_source(hint, false, false, nullptr);
+}
+
+void CaptureStream::resetStats()
+{
+    m_stats = {};
+}
+
+void CaptureStream::setMaxFrameRate(CaptureBenchmarkExtensionManager *extensionManager,
+                                    uint32_t fps)
+{
+    m_extensionManager = extensionManager;
+    m_maxFrameRate = fps;
+}
+
+void CaptureStream::setOneShot(CaptureBenchmarkShm *shm)
+{
+    m_shm = shm;
+}
+
+void CaptureStream::treeland_capture_context_v1_source_ready(int32_t,
+                                                             int32_t,
+                                                             uint32_t,
+                                                             uint32_t,
+                                                             uint32_t)
+{
+    if (m_shm) {
+        captureNext();
+        Q_EMIT started();
+        return;
+    }
+    m_session = std::make_unique<CaptureStreamSession>(create_session(), this);
+    if (m_maxFrameRate)
+        m_session->setMaxFrameRate(m_extensionManager, m_maxFrameRate);
+    m_session->start();
+    Q_EMIT started();
+}
+
+void CaptureStream::treeland_capture_context_v1_source_failed(uint32_t reason)
+{
+    Q_EMIT failed(reason);
+}
+
+void CaptureStream::handleReady(uint32_t tvSecHi, uint32_t tvSecLo, uint32_t tvUsec)
+{
+    const qint64 readyAt = qint64((quint64(tvSecHi) << 32) | tvSecLo) * 1000000 + tvUsec;
+    ++m_stats.frames;
+    m_stats.latencies.append(realtimeUs() - readyAt);
+}
+
+void CaptureStream::handleCancel()
+{
+    ++m_stats.cancels;
+}
+
+void CaptureStream::captureNext()
+{
+    // A context has at most one frame, the previous one must be gone first.
+    m_frame.reset();
+    m_captureRequestedAt = realtimeUs();
+    m_frame = std::make_unique<CaptureStreamFrame>(capture(), this);
+}
+
+::wl_buffer *CaptureStream::shmBuffer(uint32_t format,
+                                      uint32_t width,
+                                      uint32_t height,
+                                      uint32_t stride)
+{
+    const QSize size(width, height);
+    if (m_buffer && m_bufferFormat == format && m_bufferSize == size && m_bufferStride == stride)
+        return m_buffer->object();
+    if (m_buffer) {
+        m_buffer->destroy();
+        m_buffer.reset();
+    }
+    const int32_t bytes = stride * height;
+    const int fd = memfd_create("treeland-capture-benchmark", MFD_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+    if (ftruncate(fd, bytes) < 0) {
+        close(fd);
+        return nullptr;
+    }
+    QtWayland::wl_shm_pool pool(m_shm->create_pool(fd, bytes));
+    m_buffer = std::make_unique<QtWayland::wl_buffer>(
+        pool.create_buffer(0, width, height, stride, format));
+    pool.destroy();
+    close(fd);
+    m_bufferFormat = format;
+    m_bufferSize = size;
+    m_bufferStride = stride;
+    return m_buffer->object();
+}
+
+void CaptureStream::handleCaptured()
+{
+    ++m_stats.frames;
+    m_stats.latencies.append(realtimeUs() - m_captureRequestedAt);
+    // Don't destroy the frame from its own event handler.
+    QMetaObject::invokeMethod(this, &CaptureStream::captureNext, Qt::QueuedConnection);
+}
+
+DamageWindow::DamageWindow(QWindow *parent)
+    : QRasterWindow(parent)
+{
+    m_clock.start();
+}
+
+void DamageWindow::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::black);
+    // A bar sweeping across the window, new content on every frame.
+    const int x = (m_clock.elapsed() / 4) % qMax(1, width());
+    painter.fillRect(QRect(x, 0, width() / 8, height()), Qt::white);
+    painter.end();
+    if (!m_painted) {
+        m_painted = true;
+        Q_EMIT firstPainted();
+    }
+    requestUpdate();
+}
+
+CaptureBenchmark::CaptureBenchmark(const Options &options, QObject *parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_manager(new CaptureBenchmarkManager)
+    , m_extensionManager(new CaptureBenchmarkExtensionManager)
+    , m_shm(new CaptureBenchmarkShm)
+    , m_window(new DamageWindow)
+{
+}
+
+CaptureBenchmark::~CaptureBenchmark()
+{
+    qDeleteAll(m_streams);
+    delete m_window;
+    delete m_shm;
+    delete m_extensionManager;
+    delete m_manager;
+}
+
+void CaptureBenchmark::start()
+{
+    connect(m_manager,
+            &CaptureBenchmarkManager::activeChanged,
+            this,
+            &CaptureBenchmark::tryStartStreams);
+    connect(m_extensionManager,
+            &CaptureBenchmarkExtensionManager::activeChanged,
+            this,
+            &CaptureBenchmark::tryStartStreams);
+    connect(m_shm, &CaptureBenchmarkShm::activeChanged, this, &CaptureBenchmark::tryStartStreams);
+    connect(m_window, &DamageWindow::firstPainted, this, &CaptureBenchmark::tryStartStreams);
+    m_window->resize(640, 480);
+    m_window->show();
+}
+
+void CaptureBenchmark::tryStartStreams()
+{
+    if (!m_manager->isActive() || !m_window->painted() || !m_streams.isEmpty())
+        return;
+    // Frame rate limit is a request of the session extension.
+    if (m_options.maxFrameRate && !m_extensionManager->isActive())
+        return;
+    if (m_options.oneShot && !m_shm->isActive())
+        return;
+    m_compositorPid = compositorPid();
+    startNextStream();
+}
+
+void CaptureBenchmark::startNextStream()
+{
+    if (m_streams.size() == m_options.streams) {
+        QTimer::singleShot(m_options.warmupMs, this, &CaptureBenchmark::beginMeasure);
+        return;
+    }
+    const auto source = m_options.sources.at(m_streams.size() % m_options.sources.size());
+    auto stream = new CaptureStream(m_manager->get_context(), source);
+    m_streams.append(stream);
+    stream->setMaxFrameRate(m_extensionManager, m_options.maxFrameRate);
+    if (m_options.oneShot)
+        stream->setOneShot(m_shm);
+    // Selector handles one context at a time, select sources one by one.
+    connect(stream,
+            &CaptureStream::started,
+            this,
+            &CaptureBenchmark::startNextStream,
+            Qt::QueuedConnection);
+    connect(stream, &CaptureStream::failed, this, [this, stream](uint32_t reason) {
+        if (reason == SelectorBusy) {
+            QTimer::singleShot(SelectRetryInterval, stream, &CaptureStream::select);
+            return;
+        }
+        qCritical() << "Failed to select" << stream->source() << "source, reason:" << reason;
+        Q_EMIT finished(false);
+    });
+    stream->select();
+}
+
+void CaptureBenchmark::beginMeasure()
+{
+    for (auto stream : std::as_const(m_streams))
+        stream->resetStats();
+    m_compositorCpuStart = m_compositorPid ? processCpuUs(m_compositorPid) : -1;
+    m_clientCpuStart = selfCpuUs();
+    m_elapsed.start();
+    QTimer::singleShot(m_options.durationMs, this, &CaptureBenchmark::endMeasure);
+}
+
+void CaptureBenchmark::endMeasure()
+{
+    const qint64 elapsedUs = m_elapsed.nsecsElapsed() / 1000;
+    const qint64 compositorCpuEnd = m_compositorPid ? processCpuUs(m_compositorPid) : -1;
+    const qint64 compositorCpuUs = m_compositorCpuStart < 0 || compositorCpuEnd < 0
+        ? -1
+        : compositorCpuEnd - m_compositorCpuStart;
+    const QString text = report(elapsedUs, compositorCpuUs, selfCpuUs() - m_clientCpuStart);
+    if (m_options.reportFile.isEmpty()) {
+        QTextStream(stdout) << text;
+        Q_EMIT finished(true);
+        return;
+    }
+    // Written atomically, the launcher polls for this file.
+    QSaveFile file(m_options.reportFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCritical() << "Cannot write report to" << m_options.reportFile;
+        Q_EMIT finished(false);
+        return;
+    }
+    file.write(text.toUtf8());
+    Q_EMIT finished(file.commit());
+}
+
+QString CaptureBenchmark::report(qint64 elapsedUs, qint64 compositorCpuUs, qint64 clientCpuUs) const
+{
+    QString text;
+    QTextStream out(&text);
+    const auto sourceEnum = QMetaEnum::fromType<CaptureStream::Source>();
+    int totalFrames = 0;
+    out << "mode: " << (m_options.oneShot ? "one-shot capture" : "session") << "\n";
+    out << QStringLiteral("%1 %2 %3 %4 %5 %6 %7\n")
+               .arg("stream", -8)
+               .arg("source", -8)
+               .arg("frames", 8)
+               .arg("fps", 8)
+               .arg("p50(ms)", 8)
+               .arg("p95(ms)", 8)
+               .arg("p99(ms)", 8);
+    for (int i = 0; i < m_streams.size(); ++i) {
+        const auto &stats = m_streams.at(i)->stats();
+        auto latencies = stats.latencies;
+        std::sort(latencies.begin(), latencies.end());
+        totalFrames += stats.frames;
+        out << QStringLiteral("%1 %2 %3 %4 %5 %6 %7\n")
+                   .arg(i, -8)
+                   .arg(sourceEnum.valueToKey(m_streams.at(i)->source()), -8)
+                   .arg(stats.frames, 8)
+                   .arg(stats.frames * 1e6 / elapsedUs, 8, 'f', 1)
+                   .arg(percentileMs(latencies, 0.50), 8, 'f', 2)
+                   .arg(percentileMs(latencies, 0.95), 8, 'f', 2)
+                   .arg(percentileMs(latencies, 0.99), 8, 'f', 2);
+        if (stats.cancels)
+            out << "  cancelled " << stats.cancels << " times\n";
+    }
+    const auto perFrame = [totalFrames](qint64 cpuUs) {
+        return totalFrames ? QString::number(cpuUs / 1000.0 / totalFrames, 'f', 3)
+                           : QStringLiteral("-");
+    };
+    out << "duration: " << QString::number(elapsedUs / 1e6, 'f', 2) << " s, frames: " << totalFrames
+        << "\n";
+    if (compositorCpuUs >= 0) {
+        out << "compositor cpu: " << QString::number(compositorCpuUs * 100.0 / elapsedUs, 'f', 1)
+            << "% of a core, " << perFrame(compositorCpuUs) << " ms/frame\n";
+    } else {
+        out << "compositor cpu: unavailable\n";
+    }
+    out << "client cpu: " << QString::number(clientCpuUs * 100.0 / elapsedUs, 'f', 1)
+        << "% of a core, " << perFrame(clientCpuUs) << " ms/frame\n";
+    return text;
+}
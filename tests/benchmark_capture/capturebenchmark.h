@@ -0,0 +1,197 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#pragma once
+
+#include "qwayland-treeland-capture-session-extension-unstable-v1.h"
+#include "qwayland-treeland-capture-unstable-v1.h"
+
+#include <QtWaylandClient/QWaylandClientExtension>
+#include <QtWaylandClient/private/qwayland-wayland.h>
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QRasterWindow>
+#include <QSize>
+#include <QTimer>
+
+#include <memory>
+
+#include <sys/types.h>
+
+class CaptureBenchmarkManager
+    : public QWaylandClientExtensionTemplate<CaptureBenchmarkManager>
+    , public QtWayland::treeland_capture_manager_v1
+{
+    Q_OBJECT
+public:
+    CaptureBenchmarkManager();
+};
+
+class CaptureBenchmarkExtensionManager
+    : public QWaylandClientExtensionTemplate<CaptureBenchmarkExtensionManager>
+    , public QtWayland::treeland_capture_session_extension_manager_v1
+{
+    Q_OBJECT
+public:
+    CaptureBenchmarkExtensionManager();
+};
+
+// Allocates the client buffers of one-shot captures.
+class CaptureBenchmarkShm
+    : public QWaylandClientExtensionTemplate<CaptureBenchmarkShm>
+    , public QtWayland::wl_shm
+{
+    Q_OBJECT
+public:
+    CaptureBenchmarkShm();
+};
+
+struct CaptureStreamStats
+{
+    int frames{ 0 };
+    int cancels{ 0 };
+    // Compositor render to client receive for sessions, capture request to ready for
+    // one-shot captures, in microseconds.
+    QList<qint64> latencies;
+};
+
+class CaptureStreamSession;
+class CaptureStreamFrame;
+
+class CaptureStream
+    : public QObject
+    , public QtWayland::treeland_capture_context_v1
+{
+    Q_OBJECT
+public:
+    enum Source
+    {
+        Output,
+        Window,
+        Region
+    };
+    Q_ENUM(Source)
+
+    CaptureStream(::treeland_capture_context_v1 *object, Source source, QObject *parent = nullptr);
+    ~CaptureStream() override;
+
+    inline Source source() const
+    {
+        return m_source;
+    }
+
+    inline const CaptureStreamStats &stats() const
+    {
+        return m_stats;
+    }
+
+    void select();
+    void resetStats();
+    // Applied to the session through the extension once the source is ready.
+    void setMaxFrameRate(CaptureBenchmarkExtensionManager *extensionManager, uint32_t fps);
+    // Capture with one-shot capture requests instead of a session, one at a time.
+    void setOneShot(CaptureBenchmarkShm *shm);
+
+Q_SIGNALS:
+    void started();
+    void failed(uint32_t reason);
+
+protected:
+    void treeland_capture_context_v1_source_ready(int32_t region_x,
+                                                  int32_t region_y,
+                                                  uint32_t region_width,
+                                                  uint32_t region_height,
+                                                  uint32_t source_type) override;
+    void treeland_capture_context_v1_source_failed(uint32_t reason) override;
+
+private:
+    friend class CaptureStreamSession;
+    friend class CaptureStreamFrame;
+    void handleReady(uint32_t tvSecHi, uint32_t tvSecLo, uint32_t tvUsec);
+    void handleCancel();
+    void captureNext();
+    ::wl_buffer *shmBuffer(uint32_t format, uint32_t width, uint32_t height, uint32_t stride);
+    void handleCaptured();
+
+    Source m_source;
+    CaptureBenchmarkExtensionManager *m_extensionManager{ nullptr };
+    uint32_t m_maxFrameRate{ 0 };
+    std::unique_ptr<CaptureStreamSession> m_session;
+    CaptureBenchmarkShm *m_shm{ nullptr };
+    std::unique_ptr<CaptureStreamFrame> m_frame;
+    // Reused by the following captures as long as the frame layout stays the same.
+    std::unique_ptr<QtWayland::wl_buffer> m_buffer;
+    uint32_t m_bufferFormat{ 0 };
+    QSize m_bufferSize;
+    uint32_t m_bufferStride{ 0 };
+    qint64 m_captureRequestedAt{ 0 };
+    CaptureStreamStats m_stats;
+};
+
+// Keeps repainting so every capture source receives damage each output frame.
+class DamageWindow : public QRasterWindow
+{
+    Q_OBJECT
+public:
+    explicit DamageWindow(QWindow *parent = nullptr);
+
+    inline bool painted() const
+    {
+        return m_painted;
+    }
+
+Q_SIGNALS:
+    void firstPainted();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    QElapsedTimer m_clock;
+    bool m_painted{ false };
+};
+
+class CaptureBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    struct Options
+    {
+        QList<CaptureStream::Source> sources;
+        int streams{ 3 };
+        int warmupMs{ 1000 };
+        int durationMs{ 10000 };
+        // 0 means no limit.
+        uint32_t maxFrameRate{ 0 };
+        bool oneShot{ false };
+        QString reportFile;
+    };
+
+    explicit CaptureBenchmark(const Options &options, QObject *parent = nullptr);
+    ~CaptureBenchmark() override;
+
+    void start();
+
+Q_SIGNALS:
+    void finished(bool ok);
+
+private:
+    void tryStartStreams();
+    void startNextStream();
+    void beginMeasure();
+    void endMeasure();
+    QString report(qint64 elapsedUs, qint64 compositorCpuUs, qint64 clientCpuUs) const;
+
+    Options m_options;
+    CaptureBenchmarkManager *m_manager{ nullptr };
+    CaptureBenchmarkExtensionManager *m_extensionManager{ nullptr };
+    CaptureBenchmarkShm *m_shm{ nullptr };
+    DamageWindow *m_window{ nullptr };
+    QList<CaptureStream *> m_streams;
+    QElapsedTimer m_elapsed;
+    pid_t m_compositorPid{ 0 };
+    qint64 m_compositorCpuStart{ 0 };
+    qint64 m_clientCpuStart{ 0 };
+};
@@ -0,0 +1,169 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+// Capture throughput benchmark.
+//
+// By default it launches treeland on the wlroots headless backend, with capture sources
+// selected automatically, and runs itself inside as the capture client. With --client it
+// only runs the client part against the compositor in WAYLAND_DISPLAY, which must have
+// been started with TREELAND_CAPTURE_AUTO_SELECT set.
+
+#include "capturebenchmark.h"
+
+#include <QCommandLineParser>
+#include <QFile>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QTimer>
+
+static constexpr int ReportPollInterval = 250;
+
+static QString quoteExecArg(QString arg)
+{
+    arg.replace('\\', "\\\\").replace('"', "\\\"");
+    return '"' + arg + '"';
+}
+
+static int runClient(int argc, char *argv[], const QCommandLineParser &options)
+{
+    qputenv("QT_QPA_PLATFORM", "wayland");
+    QGuiApplication app(argc, argv);
+
+    CaptureBenchmark::Options benchmarkOptions;
+    const auto sources = options.value("sources").split(',', Qt::SkipEmptyParts);
+    for (const auto &source : sources) {
+        if (source == "output") {
+            benchmarkOptions.sources.append(CaptureStream::Output);
+        } else if (source == "window") {
+            benchmarkOptions.sources.append(CaptureStream::Window);
+        } else if (source == "region") {
+            benchmarkOptions.sources.append(CaptureStream::Region);
+        } else {
+            qCritical() << "Unknown capture source" << source;
+            return 1;
+        }
+    }
+    if (benchmarkOptions.sources.isEmpty())
+        return 1;
+    benchmarkOptions.streams = qMax(1, options.value("streams").toInt());
+    benchmarkOptions.warmupMs = options.value("warmup").toInt();
+    benchmarkOptions.durationMs = options.value("duration").toInt();
+    benchmarkOptions.maxFrameRate = options.value("max-fps").toUInt();
+    benchmarkOptions.oneShot = options.isSet("one-shot");
+    benchmarkOptions.reportFile = options.value("report");
+
+    CaptureBenchmark benchmark(benchmarkOptions);
+    QObject::connect(&benchmark, &CaptureBenchmark::finished, &app, [](bool ok) {
+        QCoreApplication::exit(ok ? 0 : 1);
+    });
+    benchmark.start();
+    return app.exec();
+}
+
+static int runLauncher(int argc, char *argv[], const QCommandLineParser &options)
+{
+    QCoreApplication app(argc, argv);
+
+    QTemporaryDir tempDir;
+    if (!tempDir.isValid())
+        return 1;
+    const QString reportFile = tempDir.filePath("report");
+
+    QStringList clientArgs{ QCoreApplication::applicationFilePath(), "--client" };
+    for (const auto &name : { "streams", "sources", "warmup", "duration", "max-fps" }) {
+        clientArgs << QStringLiteral("--%1").arg(name) << options.value(name);
+    }
+    if (options.isSet("one-shot"))
+        clientArgs << "--one-shot";
+    clientArgs << "--report" << reportFile;
+    QStringList quotedArgs;
+    for (const auto &arg : std::as_const(clientArgs))
+        quotedArgs << quoteExecArg(arg);
+
+    auto env = QProcessEnvironment::systemEnvironment();
+    if (!env.contains("WLR_BACKENDS"))
+        env.insert("WLR_BACKENDS", "headless");
+    env.insert("TREELAND_CAPTURE_AUTO_SELECT", "1");
+
+    QProcess treeland;
+    treeland.setProgram(options.value("treeland"));
+    treeland.setArguments({ "--run", quotedArgs.join(' ') });
+    treeland.setProcessEnvironment(env);
+    treeland.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    treeland.setStandardOutputFile(QProcess::nullDevice());
+
+    int result = 1;
+    QTimer poll;
+    QObject::connect(&poll, &QTimer::timeout, &app, [&] {
+        if (!QFileInfo::exists(reportFile))
+            return;
+        QFile file(reportFile);
+        if (file.open(QIODevice::ReadOnly)) {
+            QTextStream(stdout) << file.readAll();
+            result = 0;
+        }
+        app.quit();
+    });
+    QObject::connect(&treeland, &QProcess::finished, &app, [&] {
+        qCritical() << "treeland exited before the benchmark finished";
+        app.quit();
+    });
+    QObject::connect(&treeland, &QProcess::errorOccurred, &app, [&](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            qCritical() << "Cannot start" << treeland.program();
+            app.quit();
+        }
+    });
+    // Generous limit for startup and stream selection on top of the measured time.
+    const int timeout = options.value("warmup").toInt() + options.value("duration").toInt() + 60000;
+    QTimer::singleShot(timeout, &app, [&] {
+        qCritical() << "Benchmark timed out";
+        app.quit();
+    });
+
+    treeland.start();
+    poll.start(ReportPollInterval);
+    app.exec();
+
+    treeland.disconnect(&app);
+    treeland.terminate();
+    if (!treeland.waitForFinished(5000))
+        treeland.kill();
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOptions({
+        { "client", "Only run the capture client against the current compositor." },
+        { "treeland", "Compositor to launch.", "path", "treeland" },
+        { "streams", "Number of concurrent capture sessions.", "count", "3" },
+        { "sources",
+          "Comma separated capture sources assigned to sessions in turn, "
+          "any of output, window and region.",
+          "list",
+          "output,window,region" },
+        { "warmup", "Milliseconds to run before measuring.", "ms", "1000" },
+        { "duration", "Milliseconds to measure.", "ms", "10000" },
+        { "max-fps",
+          "Frame rate limit of each session, set through the session extension. "
+          "0 means no limit.",
+          "fps",
+          "0" },
+        { "one-shot",
+          "Capture with one-shot capture requests into shm buffers instead of sessions." },
+        { "report", "Write the report to file instead of stdout.", "file" },
+    });
+    QStringList arguments;
+    for (int i = 0; i < argc; ++i)
+        arguments << QString::fromLocal8Bit(argv[i]);
+    parser.process(arguments);
+
+    return parser.isSet("client") ? runClient(argc, argv, parser)
+                                  : runLauncher(argc, argv, parser);
+}